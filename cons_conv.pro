@@ -28,10 +28,11 @@ win32:{
     LIBS += -static-libgcc -static-libstdc++ -static -lpthread
 }
 unix:{
-    LIBS += -lboost_program_options
+    LIBS += -lboost_program_options -lpthread
 }
 
 SOURCES += \
+    src/dae_parser/DaeAtomTable.cpp \
     src/dae_parser/DaeConverter.cpp \
     src/dae_parser/DaeLibraryAnimations.cpp \
     src/dae_parser/DaeLibraryControllers.cpp \
@@ -42,14 +43,20 @@ SOURCES += \
     src/obj_parser/ObjConverter.cpp \
     src/obj_parser/ObjParser.cpp \
     src/txt_export/TxtExporter.cpp \
+    src/AnimQuantize.cpp \
     src/CmdLineOptions.cpp \
     src/Exporter.cpp \
     src/InternalRep.cpp \
     src/main.cpp \
+    src/MappedFile.cpp \
     src/Parser.cpp \
-    src/utils.cpp
+    src/Skinning.cpp \
+    src/ThreadPool.cpp \
+    src/utils.cpp \
+    src/VertexWelder.cpp
 
 HEADERS += \
+    src/dae_parser/DaeAtomTable.h \
     src/dae_parser/DaeConverter.h \
     src/dae_parser/DaeLibraryAnimations.h \
     src/dae_parser/DaeLibraryControllers.h \
@@ -64,12 +71,21 @@ HEADERS += \
     src/obj_parser/ObjParser.h \
     src/txt_export/TxtExporter.h \
     src/AABB.h \
+    src/AnimQuantize.h \
     src/CmdLineOptions.h \
     src/Converter.h \
     src/Exporter.h \
+    src/FlatHashMap.h \
+    src/IndexStream.h \
     src/InternalRep.h \
+    src/MappedFile.h \
     src/Parser.h \
-    src/utils.h
+    src/SimdMath.h \
+    src/Skinning.h \
+    src/TextScan.h \
+    src/ThreadPool.h \
+    src/utils.h \
+    src/VertexWelder.h
 
 DISTFILES += \
     doc/msh.txt
@@ -0,0 +1,93 @@
+#include "AnimQuantize.h"
+#include "AABB.h"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+// Range of the three smallest components of a unit quaternion
+static float const comp_range = 0.70710678f;
+
+uint64_t EncodeRotation(glm::quat const & rot, uint32_t bits)
+{
+    assert(bits == 32 || bits == 48);
+
+    uint32_t const comp_bits = (bits - 2) / 3;
+    float const    max_code  = float((1u << comp_bits) - 1);
+
+    glm::quat q = glm::normalize(rot);
+    float     c[4] = {q.x, q.y, q.z, q.w};
+
+    uint32_t largest = 0;
+    for(uint32_t i = 1; i < 4; ++i)
+    {
+        if(std::abs(c[i]) > std::abs(c[largest]))
+            largest = i;
+    }
+
+    float sign = c[largest] < 0.0f ? -1.0f : 1.0f;
+
+    uint64_t code = largest;
+    for(uint32_t i = 0; i < 4; ++i)
+    {
+        if(i == largest)
+            continue;
+
+        float v = glm::clamp(c[i] * sign / comp_range * 0.5f + 0.5f, 0.0f, 1.0f);
+        code    = (code << comp_bits) | uint64_t(std::lround(v * max_code));
+    }
+
+    return code;
+}
+
+glm::quat DecodeRotation(uint64_t code, uint32_t bits)
+{
+    assert(bits == 32 || bits == 48);
+
+    uint32_t const comp_bits = (bits - 2) / 3;
+    uint64_t const mask      = (uint64_t(1) << comp_bits) - 1;
+    float const    max_code  = float(mask);
+
+    uint32_t largest = uint32_t(code >> (3 * comp_bits)) & 3;
+
+    float    c[4];
+    float    sum   = 0.0f;
+    uint32_t shift = 3 * comp_bits;
+    for(uint32_t i = 0; i < 4; ++i)
+    {
+        if(i == largest)
+            continue;
+
+        shift -= comp_bits;
+        c[i] = (float((code >> shift) & mask) / max_code * 2.0f - 1.0f) * comp_range;
+        sum += c[i] * c[i];
+    }
+    c[largest] = std::sqrt(std::max(0.0f, 1.0f - sum));
+
+    return glm::normalize(glm::quat(c[3], c[0], c[1], c[2]));
+}
+
+TransRange::TransRange(std::vector<glm::vec3> const & track) : TransRange()
+{
+    if(track.empty())
+        return;
+
+    AABB box;
+    box.buildBoundBox(track);
+
+    min   = box.min();
+    scale = (box.max() - box.min()) / 65535.0f;
+}
+
+void TransRange::Encode(glm::vec3 const & trans, uint16_t code[3]) const
+{
+    for(int i = 0; i < 3; ++i)
+    {
+        float v = scale[i] > 0.0f ? (trans[i] - min[i]) / scale[i] : 0.0f;
+        code[i] = static_cast<uint16_t>(std::lround(glm::clamp(v, 0.0f, 65535.0f)));
+    }
+}
+
+glm::vec3 TransRange::Decode(uint16_t const code[3]) const
+{
+    return min + glm::vec3(code[0], code[1], code[2]) * scale;
+}
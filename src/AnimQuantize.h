@@ -0,0 +1,32 @@
+#ifndef ANIMQUANTIZE_H
+#define ANIMQUANTIZE_H
+
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include <vector>
+
+//! Rotation in "smallest three" form
+/*!
+    The biggest by magnitude component is dropped and restored from the unit length,
+    the quaternion is negated to make it positive. Its index takes the 2 high bits,
+    the other three components in [-1/sqrt(2), 1/sqrt(2)] share the rest bits equally:
+    15 bits each for 48-bit codes, 10 bits each for 32-bit codes.
+*/
+uint64_t  EncodeRotation(glm::quat const & rot, uint32_t bits);
+glm::quat DecodeRotation(uint64_t code, uint32_t bits);
+
+//! Decode parameters of a 16-bit per component translation track: value = min + code * scale
+struct TransRange
+{
+    glm::vec3 min;
+    glm::vec3 scale;
+
+    TransRange() : min(0.0f), scale(0.0f) {}
+    explicit TransRange(std::vector<glm::vec3> const & track);
+
+    void      Encode(glm::vec3 const & trans, uint16_t code[3]) const;
+    glm::vec3 Decode(uint16_t const code[3]) const;
+};
+
+#endif   // ANIMQUANTIZE_H
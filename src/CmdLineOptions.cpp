@@ -20,6 +20,17 @@ bool ParseCmdLine(int argc, char ** argv, CmdLineOptions & cmd) noexcept
         config.add_options()("cache-optimize",
                              boost::program_options::value<bool>(&cmd.geometry_optimize)->default_value(true),
                              "Geometry optimization\n\t0|1")(
+            "cache-size", boost::program_options::value<uint32_t>(&cmd.cache_size)->default_value(16),
+            "Post-transform vertex cache size for geometry optimization\n\t4 - 64")(
+            "cache-algo", boost::program_options::value<std::string>()->default_value("forsyth"),
+            "Vertex cache optimization algorithm: better cache reuse or faster with less overdraw"
+            "\n\tforsyth|tipsify")(
+            "overdraw-optimize",
+            boost::program_options::value<bool>(&cmd.overdraw_optimize)->default_value(false),
+            "Reorder triangle clusters for less overdraw after cache optimization\n\t0|1")(
+            "overdraw-threshold",
+            boost::program_options::value<float>(&cmd.overdraw_threshold)->default_value(1.05f),
+            "Max ACMR growth allowed by overdraw optimization\n\t>= 1.0")(
             "export-type,E", boost::program_options::value<std::string>()->default_value("geo"),
             "Specify data for export\n\tgeo+anim")(
             "convert-type,C", boost::program_options::value<std::string>()->default_value("txt"),
@@ -29,8 +40,24 @@ bool ParseCmdLine(int argc, char ** argv, CmdLineOptions & cmd) noexcept
             "material-export",
             boost::program_options::value<bool>(&cmd.material_export)->default_value(false),
             "Flag for material export\n\t0|1")(
+            "obj-weld", boost::program_options::value<bool>(&cmd.obj_weld)->default_value(true),
+            "Weld OBJ vertices with different indices but equal attributes\n\t0|1")(
             "tex-channel", boost::program_options::value<uint32_t>(&cmd.chan)->default_value(0),
-            "texture channel for TBN calculating\n\t0 - 3");
+            "texture channel for TBN calculating\n\t0 - 3")(
+            "threads", boost::program_options::value<uint32_t>(&cmd.threads)->default_value(0),
+            "Number of threads used for parsing\n\t0 - all hardware threads")(
+            "bbox-mode", boost::program_options::value<std::string>()->default_value("joint"),
+            "Animation bounding boxes: conservative from joint bounds or exact from skinned vertices\n\tjoint|exact")(
+            "anim-rot-error", boost::program_options::value<float>(&cmd.anim_rot_error)->default_value(0.0f),
+            "Keyframe reduction: max joint rotation error in model space, degrees\n\t0 - lossless")(
+            "anim-trans-error", boost::program_options::value<float>(&cmd.anim_trans_error)->default_value(0.0f),
+            "Keyframe reduction: max joint position error in model space\n\t0 - lossless"
+            "\n\tboth 0 - key in every frame")(
+            "anim-fps", boost::program_options::value<float>(&cmd.anim_fps)->default_value(0.0f),
+            "Resample animation to the frame rate\n\t0 - keep the source frames")(
+            "anim-quantize", boost::program_options::value<std::string>()->default_value("none"),
+            "Animation encoding: smallest three rotations of 48 or 32 bits and 16-bit translations"
+            "\n\tnone|48|32");
 
         boost::program_options::options_description hiden("Hidden options");
         hiden.add_options()("input-file", boost::program_options::value<std::vector<std::string>>(),
@@ -85,16 +112,118 @@ bool ParseCmdLine(int argc, char ** argv, CmdLineOptions & cmd) noexcept
         cmd.geometry_optimize = vm["cache-optimize"].as<bool>();
     }
 
+    if(vm.count("cache-size"))
+    {
+        cmd.cache_size = vm["cache-size"].as<uint32_t>();
+        if(cmd.cache_size < 4 || cmd.cache_size > 64)
+        {
+            std::cerr << "ERROR! Invalid --cache-size parameter" << std::endl;
+            return false;
+        }
+    }
+
+    if(vm.count("cache-algo"))
+    {
+        if(vm["cache-algo"].as<std::string>() == std::string("forsyth"))
+            cmd.cache_tipsify = false;
+        else if(vm["cache-algo"].as<std::string>() == std::string("tipsify"))
+            cmd.cache_tipsify = true;
+        else
+        {
+            std::cerr << "ERROR! Invalid --cache-algo parameter" << std::endl;
+            return false;
+        }
+    }
+
+    if(vm.count("overdraw-optimize"))
+    {
+        cmd.overdraw_optimize = vm["overdraw-optimize"].as<bool>();
+    }
+
+    if(vm.count("overdraw-threshold"))
+    {
+        cmd.overdraw_threshold = vm["overdraw-threshold"].as<float>();
+        if(cmd.overdraw_threshold < 1.0f)
+        {
+            std::cerr << "ERROR! Invalid --overdraw-threshold parameter" << std::endl;
+            return false;
+        }
+    }
+
     if(vm.count("material-export"))
     {
         cmd.material_export = vm["material-export"].as<bool>();
     }
 
+    if(vm.count("obj-weld"))
+    {
+        cmd.obj_weld = vm["obj-weld"].as<bool>();
+    }
+
     if(vm.count("tex-channel"))
     {
         cmd.chan = vm["tex-channel"].as<uint32_t>();
     }
 
+    if(vm.count("threads"))
+    {
+        cmd.threads = vm["threads"].as<uint32_t>();
+    }
+
+    if(vm.count("anim-rot-error"))
+    {
+        cmd.anim_rot_error = vm["anim-rot-error"].as<float>();
+    }
+
+    if(vm.count("anim-trans-error"))
+    {
+        cmd.anim_trans_error = vm["anim-trans-error"].as<float>();
+    }
+
+    if(vm.count("anim-fps"))
+    {
+        cmd.anim_fps = vm["anim-fps"].as<float>();
+        if(cmd.anim_fps < 0.0f)
+        {
+            std::cerr << "ERROR! Negative --anim-fps parameter" << std::endl;
+            return false;
+        }
+    }
+
+    if(cmd.anim_rot_error < 0.0f || cmd.anim_trans_error < 0.0f)
+    {
+        std::cerr << "ERROR! Negative keyframe reduction error bound" << std::endl;
+        return false;
+    }
+
+    if(vm.count("anim-quantize"))
+    {
+        if(vm["anim-quantize"].as<std::string>() == std::string("none"))
+            cmd.anim_rot_bits = 0;
+        else if(vm["anim-quantize"].as<std::string>() == std::string("48"))
+            cmd.anim_rot_bits = 48;
+        else if(vm["anim-quantize"].as<std::string>() == std::string("32"))
+            cmd.anim_rot_bits = 32;
+        else
+        {
+            std::cerr << "ERROR! Invalid --anim-quantize parameter" << std::endl;
+            return false;
+        }
+    }
+
+    if(vm.count("bbox-mode"))
+    {
+        if(vm["bbox-mode"].as<std::string>() == std::string("joint"))
+            cmd.exact_bboxes = false;
+        else if(vm["bbox-mode"].as<std::string>() == std::string("exact"))
+            cmd.exact_bboxes = true;
+        else
+        {
+            std::cerr << "ERROR! Invalid --bbox-mode parameter" << std::endl;
+            return false;
+        }
+    }
+
     if(vm.count("convert-type"))
     {
         if(vm["convert-type"].as<std::string>().size() == 3)
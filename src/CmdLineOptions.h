@@ -7,23 +7,49 @@
 struct CmdLineOptions
 {
     bool     geometry_optimize;   // cashe optimization
+    bool     cache_tipsify;       // cache optimization algorithm: Tipsify, otherwise Forsyth
+    bool     overdraw_optimize;   // reorder triangle clusters for less overdraw after cache optimization
     bool     plain_text_export;   // export file type
     bool     material_export;     // export material
     bool     geometry;            // export geometry
     bool     animation;           // export animation
     bool     relative;            // animation matrix type export
+    bool     obj_weld;            // weld obj vertices with equal attributes
+    bool     exact_bboxes;        // animation bboxes from skinned vertices, otherwise from joint bounds
+    float    overdraw_threshold;  // ACMR of reordered clusters relative to the cache optimized order
+    float    anim_rot_error;      // keyframe reduction rotation error bound in degrees
+    float    anim_trans_error;    // keyframe reduction translation error bound, 0 and 0 - no reduction
+    float    anim_fps;            // animation resampling frame rate, 0 - keep the source frames
+    uint32_t anim_rot_bits;       // quantized animation rotation size: 48 or 32, 0 - no quantization
+    uint32_t cache_size;          // vertex cache size the index order is optimized for
     uint32_t chan;                // texture channel for TBN calculating
+    uint32_t threads;             // worker threads, 0 - all hardware threads
 
     std::vector<std::string> file_list;
 
+    // Joint tracks the exporters consume, converters compute only these
+    bool NeedRelativeTracks() const { return animation && relative; }
+    bool NeedAbsoluteTracks() const { return animation && !relative; }
+
     CmdLineOptions() :
         geometry_optimize(false),
+        cache_tipsify(false),
+        overdraw_optimize(false),
         plain_text_export(false),
         material_export(false),
         geometry(false),
         animation(false),
         relative(true),
-        chan(0)
+        obj_weld(true),
+        exact_bboxes(false),
+        overdraw_threshold(1.05f),
+        anim_rot_error(0.0f),
+        anim_trans_error(0.0f),
+        anim_fps(0.0f),
+        anim_rot_bits(0),
+        cache_size(16),
+        chan(0),
+        threads(0)
     {}
 };
 
@@ -0,0 +1,132 @@
+#ifndef FLATHASHMAP_H
+#define FLATHASHMAP_H
+
+#include <cstdint>
+#include <functional>
+#include <utility>
+#include <vector>
+
+//! Finalizer of MurmurHash3, spreads the bits of a hash over the whole word
+inline uint64_t HashMix(uint64_t h)
+{
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+
+    return h;
+}
+
+inline uint64_t HashCombine(uint64_t seed, uint64_t value)
+{
+    return HashMix(seed ^ (value + 0x9e3779b97f4a7c15ULL + (seed << 6) + (seed >> 2)));
+}
+
+//! Open addressing hash map with linear probing
+/*!
+    Keys and values live in one flat array, so a lookup usually touches a single
+    cache line and inserting does not allocate per element. Erasing is not supported:
+    the map is meant for build-once lookup tables (vertex welding, index deduplication).
+*/
+template<typename Key, typename Value, typename Hash = std::hash<Key>, typename KeyEqual = std::equal_to<Key>>
+class FlatHashMap
+{
+    struct Slot
+    {
+        Key   key;
+        Value value;
+        bool  used;
+    };
+
+    std::vector<Slot> m_slots;
+    size_t            m_size;
+    Hash              m_hash;
+    KeyEqual          m_equal;
+
+    size_t FindSlot(Key const & key) const
+    {
+        size_t mask = m_slots.size() - 1;
+        size_t pos  = static_cast<size_t>(HashMix(static_cast<uint64_t>(m_hash(key)))) & mask;
+
+        while(m_slots[pos].used && !m_equal(m_slots[pos].key, key))
+            pos = (pos + 1) & mask;
+
+        return pos;
+    }
+
+    void Rehash(size_t capacity)
+    {
+        std::vector<Slot> old(capacity, Slot{Key(), Value(), false});
+        m_slots.swap(old);
+
+        for(auto & slot : old)
+        {
+            if(slot.used)
+                m_slots[FindSlot(slot.key)] = std::move(slot);
+        }
+    }
+
+public:
+    FlatHashMap() : m_size(0) {}
+
+    size_t Size() const { return m_size; }
+    bool   Empty() const { return m_size == 0; }
+
+    void Clear()
+    {
+        m_slots.clear();
+        m_size = 0;
+    }
+
+    //! Make room for count elements without rehashing (load factor <= 0.5)
+    void Reserve(size_t count)
+    {
+        size_t capacity = 16;
+        while(capacity < count * 2)
+            capacity *= 2;
+
+        if(capacity > m_slots.size())
+            Rehash(capacity);
+    }
+
+    Value * Find(Key const & key)
+    {
+        if(m_size == 0)
+            return nullptr;
+
+        Slot & slot = m_slots[FindSlot(key)];
+        return slot.used ? &slot.value : nullptr;
+    }
+
+    Value const * Find(Key const & key) const
+    {
+        if(m_size == 0)
+            return nullptr;
+
+        Slot const & slot = m_slots[FindSlot(key)];
+        return slot.used ? &slot.value : nullptr;
+    }
+
+    /*! Insert value for key if the key is absent
+        \return pointer to the stored value and true if the value was inserted
+    */
+    std::pair<Value *, bool> Insert(Key const & key, Value const & value)
+    {
+        if((m_size + 1) * 2 > m_slots.size())
+            Reserve(m_size + 1);
+
+        Slot & slot = m_slots[FindSlot(key)];
+        if(slot.used)
+            return {&slot.value, false};
+
+        slot.key   = key;
+        slot.value = value;
+        slot.used  = true;
+        ++m_size;
+
+        return {&slot.value, true};
+    }
+};
+
+#endif   // FLATHASHMAP_H
@@ -0,0 +1,104 @@
+#ifndef INDEXSTREAM_H
+#define INDEXSTREAM_H
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+//! Index data of triangle corners in one contiguous array
+/*!
+    Every corner holds Stride() attribute indices (position, normal, tex coord, ...),
+    corners follow each other without gaps, every 3 corners form a triangle.
+*/
+class IndexStream
+{
+    uint32_t              m_stride;
+    std::vector<uint32_t> m_data;
+
+public:
+    //! Read only view of one corner
+    class Corner
+    {
+        uint32_t const * m_data;
+        uint32_t         m_size;
+
+    public:
+        Corner(uint32_t const * data, uint32_t size) : m_data(data), m_size(size) {}
+
+        uint32_t         size() const { return m_size; }
+        uint32_t         operator[](uint32_t i) const { return m_data[i]; }
+        uint32_t const * begin() const { return m_data; }
+        uint32_t const * end() const { return m_data + m_size; }
+    };
+
+    class ConstIterator
+    {
+        uint32_t const * m_ptr;
+        uint32_t         m_stride;
+
+    public:
+        ConstIterator(uint32_t const * ptr, uint32_t stride) : m_ptr(ptr), m_stride(stride) {}
+
+        Corner          operator*() const { return Corner(m_ptr, m_stride); }
+        ConstIterator & operator++()
+        {
+            m_ptr += m_stride;
+            return *this;
+        }
+        bool operator!=(ConstIterator const & rhs) const { return m_ptr != rhs.m_ptr; }
+        bool operator==(ConstIterator const & rhs) const { return m_ptr == rhs.m_ptr; }
+    };
+
+    explicit IndexStream(uint32_t stride = 0) : m_stride(stride) {}
+
+    uint32_t Stride() const { return m_stride; }
+
+    //! Stride can be changed only while the stream is empty
+    void SetStride(uint32_t stride)
+    {
+        assert(m_data.empty() || stride == m_stride);
+        m_stride = stride;
+    }
+
+    //! Number of corners
+    size_t Size() const { return m_stride == 0 ? 0 : m_data.size() / m_stride; }
+    bool   Empty() const { return m_data.empty(); }
+
+    void Reserve(size_t corners) { m_data.reserve(corners * m_stride); }
+    void Clear() { m_data.clear(); }
+
+    Corner operator[](size_t corner) const { return Corner(&m_data[corner * m_stride], m_stride); }
+
+    uint32_t *       CornerData(size_t corner) { return &m_data[corner * m_stride]; }
+    uint32_t const * CornerData(size_t corner) const { return &m_data[corner * m_stride]; }
+
+    ConstIterator begin() const { return ConstIterator(m_data.data(), m_stride); }
+    ConstIterator end() const { return ConstIterator(m_data.data() + m_data.size(), m_stride); }
+
+    //! Append corner of Stride() indices
+    void PushCorner(uint32_t const * corner) { m_data.insert(m_data.end(), corner, corner + m_stride); }
+
+    //! Append a copy of an already stored corner (fan triangulation reuses corners)
+    void PushCopy(size_t corner)
+    {
+        size_t src = corner * m_stride;
+        size_t dst = m_data.size();
+
+        m_data.resize(dst + m_stride);
+        for(uint32_t i = 0; i < m_stride; ++i)
+            m_data[dst + i] = m_data[src + i];
+    }
+
+    //! Append all corners of other, strides must match
+    void Append(IndexStream const & other)
+    {
+        assert(other.Empty() || m_data.empty() || other.m_stride == m_stride);
+        if(m_data.empty())
+            m_stride = other.m_stride;
+
+        m_data.insert(m_data.end(), other.m_data.begin(), other.m_data.end());
+    }
+};
+
+#endif   // INDEXSTREAM_H
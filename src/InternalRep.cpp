@@ -1,220 +1,929 @@
 #include "InternalRep.h"
+#include "FlatHashMap.h"
+#include "SimdMath.h"
+#include "Skinning.h"
+#include "ThreadPool.h"
 #include "utils.h"
 #include <algorithm>
 #include <cmath>
 #include <iostream>
-#include <list>
-#include <set>
+#include <limits>
 #include <sstream>
 #include <stdexcept>
 
-InternalData::InternalData() : num_frames(0), frame_rate(0.0f) {}
+InternalData::InternalData() : num_frames(0), frame_rate(0.0f), duration(0.0f), cache_size(16) {}
 
-unsigned int InternalData::RemoveDegeneratedTriangles()
+static bool NearValue(glm::vec3 const & a, glm::vec3 const & b)
 {
-    unsigned int num_deg_tris = 0;
+    return VecEqual(a, b);
+}
 
-    for(auto & mesh : meshes)
+// q and -q are the same rotation
+static bool NearValue(glm::quat const & a, glm::quat b)
+{
+    if(glm::dot(a, b) < 0.0f)
+        b = -b;
+
+    return IsNear(a.x, b.x) && IsNear(a.y, b.y) && IsNear(a.z, b.z) && IsNear(a.w, b.w);
+}
+
+static glm::vec3 IdentityValue(glm::vec3 const *)
+{
+    return glm::vec3(0.0f);
+}
+
+static glm::quat IdentityValue(glm::quat const *)
+{
+    return glm::quat(1.0f, 0.0f, 0.0f, 0.0f);
+}
+
+template<typename T>
+void InternalData::Track<T>::Assign(std::vector<T> && frames)
+{
+    values = std::move(frames);
+    type   = TrackType::ANIMATED;
+    if(values.empty())
+        return;
+
+    for(size_t i = 1; i < values.size(); ++i)
     {
-        for(unsigned int i = 0; i < mesh.indexes.size(); i += 3)
+        if(!NearValue(values[i], values[0]))
+            return;
+    }
+
+    T identity = IdentityValue(&values[0]);
+    type       = NearValue(values[0], identity) ? TrackType::IDENTITY : TrackType::CONSTANT;
+    values.assign(1, type == TrackType::IDENTITY ? identity : values[0]);
+    values.shrink_to_fit();
+}
+
+template struct InternalData::Track<glm::quat>;
+template struct InternalData::Track<glm::vec3>;
+
+// Moves vertex v of a per vertex array to remap[v], arrays of other sizes (absent attributes) are kept
+template<typename T>
+static void RemapVertexArray(std::vector<T> & arr, std::vector<uint32_t> const & remap, uint32_t new_count)
+{
+    if(arr.size() != remap.size())
+        return;
+
+    std::vector<T> out(new_count);
+    for(size_t v = 0; v < remap.size(); ++v)
+    {
+        if(remap[v] < new_count)
+            out[remap[v]] = std::move(arr[v]);
+    }
+
+    arr.swap(out);
+}
+
+// Moves vertex v of every attribute of the mesh to remap[v], vertices mapped past new_count are dropped
+static void RemapVertices(InternalData::SubMesh & mesh, std::vector<uint32_t> const & remap, uint32_t new_count)
+{
+    RemapVertexArray(mesh.pos, remap, new_count);
+    RemapVertexArray(mesh.weights, remap, new_count);
+    RemapVertexArray(mesh.normal, remap, new_count);
+    RemapVertexArray(mesh.tangent, remap, new_count);
+    RemapVertexArray(mesh.bitangent, remap, new_count);
+    RemapVertexArray(mesh.color, remap, new_count);
+    for(auto & channel : mesh.tex_coords)
+        RemapVertexArray(channel, remap, new_count);
+
+    if(new_count < remap.size() && !mesh.pos.empty())
+        mesh.bbox.buildBoundBox(mesh.pos);
+}
+
+// Triangle vertices rotated to start from the smallest index, the winding is kept
+struct TriangleKey
+{
+    uint32_t v[3];
+
+    TriangleKey() : v{0, 0, 0} {}
+    TriangleKey(uint32_t a, uint32_t b, uint32_t c)
+    {
+        uint32_t first  = a < b ? (a < c ? 0 : 2) : (b < c ? 1 : 2);
+        uint32_t tri[3] = {a, b, c};
+        for(uint32_t k = 0; k < 3; ++k)
+            v[k] = tri[(first + k) % 3];
+    }
+
+    bool operator==(TriangleKey const & rhs) const { return v[0] == rhs.v[0] && v[1] == rhs.v[1] && v[2] == rhs.v[2]; }
+};
+
+struct TriangleKeyHash
+{
+    size_t operator()(TriangleKey const & key) const { return HashCombine(HashCombine(key.v[0], key.v[1]), key.v[2]); }
+};
+
+InternalData::CleanupStats InternalData::RemoveDegeneratedTriangles()
+{
+    std::vector<CleanupStats> mesh_stats(meshes.size(), CleanupStats{0, 0, 0});
+
+    ThreadPool::Instance().ParallelFor(static_cast<uint32_t>(meshes.size()), [&](uint32_t m) {
+        SubMesh &      mesh  = meshes[m];
+        CleanupStats & stats = mesh_stats[m];
+
+        FlatHashMap<TriangleKey, bool, TriangleKeyHash> tris;
+        tris.Reserve(mesh.indexes.size() / 3);
+
+        // Stable compaction of the kept triangles
+        size_t kept = 0;
+        for(size_t i = 0; i + 2 < mesh.indexes.size(); i += 3)
         {
-            glm::vec3 v1 = mesh.pos[mesh.indexes[i + 0]];
-            glm::vec3 v2 = mesh.pos[mesh.indexes[i + 1]];
-            glm::vec3 v3 = mesh.pos[mesh.indexes[i + 2]];
+            uint32_t i1 = mesh.indexes[i + 0];
+            uint32_t i2 = mesh.indexes[i + 1];
+            uint32_t i3 = mesh.indexes[i + 2];
+
+            glm::vec3 const & v1 = mesh.pos[i1];
+            glm::vec3 const & v2 = mesh.pos[i2];
+            glm::vec3 const & v3 = mesh.pos[i3];
 
             if(glm::length(glm::cross((v2 - v1), (v3 - v1))) < Epsilon<float>::epsilon())
             {
-                num_deg_tris++;
-                // Remove triangle indices
-                mesh.indexes.erase(mesh.indexes.begin() + i + 2);
-                mesh.indexes.erase(mesh.indexes.begin() + i + 1);
-                mesh.indexes.erase(mesh.indexes.begin() + i + 0);
-                i -= 3;
+                ++stats.degenerate_tris;
+                continue;
+            }
+
+            if(!tris.Insert(TriangleKey(i1, i2, i3), true).second)
+            {
+                ++stats.duplicate_tris;
+                continue;
             }
+
+            mesh.indexes[kept + 0] = i1;
+            mesh.indexes[kept + 1] = i2;
+            mesh.indexes[kept + 2] = i3;
+            kept += 3;
+        }
+        mesh.indexes.resize(kept);
+
+        // Drop vertices no triangle references, the order of the rest is kept
+        uint32_t const        none = std::numeric_limits<uint32_t>::max();
+        std::vector<uint32_t> remap(mesh.pos.size(), none);
+        for(auto index : mesh.indexes)
+            remap[index] = 0;
+
+        uint32_t count = 0;
+        for(auto & r : remap)
+        {
+            if(r != none)
+                r = count++;
         }
+
+        stats.unused_verts = static_cast<unsigned int>(remap.size() - count);
+        if(stats.unused_verts == 0)
+            return;
+
+        for(auto & index : mesh.indexes)
+            index = remap[index];
+
+        RemapVertices(mesh, remap, count);
+    });
+
+    CleanupStats total = {0, 0, 0};
+    for(auto const & stats : mesh_stats)
+    {
+        total.degenerate_tris += stats.degenerate_tris;
+        total.duplicate_tris += stats.duplicate_tris;
+        total.unused_verts += stats.unused_verts;
     }
 
-    return num_deg_tris;
+    return total;
 }
 
 //===========================================================================//
 
-struct OptFace;
-struct OptVertex
+// Vertex -> triangles adjacency in CSR form: triangles of vertex v are adj_tris[adj_offset[v], adj_offset[v + 1])
+static void BuildTriangleAdjacency(std::vector<uint32_t> const & indexes, size_t num_verts,
+                                   std::vector<uint32_t> & adj_offset, std::vector<uint32_t> & adj_tris)
 {
-    unsigned int        index = {0};   // Index in vertex array
-    float               score = {0.0f};
-    std::set<OptFace *> faces = {};   // Faces that are using this vertex
+    size_t num_indexes = indexes.size() / 3 * 3;
 
-    void UpdateScore(int cacheIndex);
-};
+    adj_offset.assign(num_verts + 1, 0);
+    for(size_t i = 0; i < num_indexes; ++i)
+        ++adj_offset[indexes[i] + 1];
 
-struct OptFace
-{
-    unsigned int id;
-    OptVertex *  verts[3];
+    for(size_t v = 0; v < num_verts; ++v)
+        adj_offset[v + 1] += adj_offset[v];
 
-    OptFace(unsigned int cur_id) : id(cur_id), verts{nullptr, nullptr, nullptr} {}
-
-    float GetScore() { return verts[0]->score + verts[1]->score + verts[2]->score; }
-};
+    std::vector<uint32_t> fill(adj_offset.begin(), adj_offset.end() - 1);
+    adj_tris.resize(num_indexes);
+    for(size_t i = 0; i < num_indexes; ++i)
+        adj_tris[fill[indexes[i]]++] = static_cast<uint32_t>(i / 3);
+}
 
-void OptVertex::UpdateScore(int cache_index)
+// Score tables of the optimizer, the constants are coming from the paper
+struct ForsythScores
 {
-    if(faces.empty())
+    static constexpr uint32_t max_valence = 32;
+
+    float cache[InternalData::maxCacheSize];   // by position in the cache
+    float valence[max_valence + 1];            // by number of not emitted triangles
+
+    explicit ForsythScores(uint32_t cache_size)
     {
-        score = 0;
-        return;
+        for(uint32_t i = 0; i < cache_size; ++i)
+        {
+            if(i < 3)
+                cache[i] = 0.75f;   // Among three most recent vertices
+            else
+                cache[i] = std::pow(1.0f - float(i - 3) / float(cache_size - 3), 1.5f);
+        }
+
+        valence[0] = 0.0f;
+        for(uint32_t i = 1; i <= max_valence; ++i)
+            valence[i] = 2.0f * std::pow(float(i), -0.5f);
     }
 
-    // The constants used here are coming from the paper
-    if(cache_index < 0)
-        score = 0;   // Not in cache
-    else if(cache_index < 3)
-        score = 0.75f;   // Among three most recent vertices
-    else
-        score = std::pow(1.0f - ((cache_index - 3.0f) / InternalData::maxCacheSize), 1.5f);
+    float Vertex(int32_t cache_pos, uint32_t live_tris) const
+    {
+        if(live_tris == 0)
+            return -1.0f;   // no triangles to emit, never picked
 
-    score += 2.0f * std::pow((float)faces.size(), -0.5f);
-}
+        return (cache_pos < 0 ? 0.0f : cache[cache_pos]) + valence[std::min(live_tris, max_valence)];
+    }
+};
 
 // Implementation of Linear-Speed Vertex Cache Optimization by Tom Forsyth
 // https://tomforsyth1000.github.io/papers/fast_vert_cache_opt.html
-void InternalData::OptimizeIndexOrder()
+// Triangles of a vertex are kept in flat (CSR) arrays, the cache is a fixed-size array and
+// only triangles of the cached vertices are rescored. When none of them is left the next
+// triangle is taken in the original order.
+static void OptimizeForsyth(std::vector<uint32_t> & indexes, size_t num_verts, uint32_t cache_size)
 {
-    for(auto & mesh : meshes)
+    uint32_t const num_tris = static_cast<uint32_t>(indexes.size() / 3);
+    if(num_tris == 0)
+        return;
+
+    ForsythScores const scores(cache_size);
+
+    // Vertex -> triangles adjacency, live_tris[v] first entries of the vertex range are not emitted
+    std::vector<uint32_t> adj_offset, adj_tris;
+    BuildTriangleAdjacency(indexes, num_verts, adj_offset, adj_tris);
+
+    std::vector<uint32_t> live_tris(num_verts);
+    for(size_t v = 0; v < num_verts; ++v)
+        live_tris[v] = adj_offset[v + 1] - adj_offset[v];
+
+    std::vector<int32_t> cache_pos(num_verts, -1);
+    std::vector<float>   vert_score(num_verts);
+    for(size_t v = 0; v < num_verts; ++v)
+        vert_score[v] = scores.Vertex(-1, live_tris[v]);
+
+    std::vector<float> tri_score(num_tris);
+    std::vector<bool>  emitted(num_tris, false);
+    for(uint32_t t = 0; t < num_tris; ++t)
+        tri_score[t] = vert_score[indexes[t * 3]] + vert_score[indexes[t * 3 + 1]] + vert_score[indexes[t * 3 + 2]];
+
+    // Emitted triangle vertices are pushed in front, the entries past cache_size are evicted
+    uint32_t cache[InternalData::maxCacheSize + 3];
+    uint32_t cache_count = 0;
+
+    std::vector<uint32_t> new_index;
+    new_index.reserve(size_t(num_tris) * 3);
+
+    uint32_t next_tri  = 0;   // dead-end fallback cursor
+    int64_t  best_tri  = -1;
+    for(uint32_t emitted_count = 0; emitted_count < num_tris; ++emitted_count)
     {
-        if(mesh.indexes.empty())
-            continue;
+        if(best_tri < 0)
+        {
+            while(emitted[next_tri])
+                ++next_tri;
+            best_tri = next_tri;
+        }
 
-        std::vector<OptVertex>    verts(mesh.pos.size());
-        std::vector<unsigned int> new_index;
-        std::list<OptFace>        faces;
-        std::list<OptVertex *>    cache;
+        uint32_t const * tri = &indexes[size_t(best_tri) * 3];
+        emitted[best_tri]    = true;
 
-        // Build vertex and triangle structures
-        for(unsigned int i = 0; i < mesh.indexes.size(); i += 3)
+        uint32_t new_cache[InternalData::maxCacheSize + 3];
+        uint32_t new_count = 0;
+        for(int k = 0; k < 3; ++k)
         {
-            faces.emplace_back(i / 3);
-            OptFace & face = faces.back();
-
-            face.verts[0] = &verts[mesh.indexes[i + 0]];
-            face.verts[1] = &verts[mesh.indexes[i + 1]];
-            face.verts[2] = &verts[mesh.indexes[i + 2]];
-            face.verts[0]->faces.insert(&face);
-            face.verts[1]->faces.insert(&face);
-            face.verts[2]->faces.insert(&face);
+            uint32_t v = tri[k];
+            new_index.push_back(v);
+
+            // Remove the triangle from the live part of the vertex range
+            uint32_t * first = &adj_tris[adj_offset[v]];
+            uint32_t * last  = first + live_tris[v];
+            std::swap(*std::find(first, last, uint32_t(best_tri)), *(last - 1));
+            --live_tris[v];
+
+            if(std::find(new_cache, new_cache + new_count, v) == new_cache + new_count)
+                new_cache[new_count++] = v;
         }
 
-        for(unsigned int i = 0; i < verts.size(); ++i)
+        for(uint32_t i = 0; i < cache_count; ++i)
         {
-            verts[i].index = i;
-            verts[i].UpdateScore(-1);
+            uint32_t v = cache[i];
+            if(v != tri[0] && v != tri[1] && v != tri[2])
+                new_cache[new_count++] = v;
+        }
+
+        // Rescore cached and evicted vertices, then their triangles
+        for(uint32_t i = 0; i < new_count; ++i)
+        {
+            uint32_t v   = new_cache[i];
+            int32_t  pos = i < cache_size ? int32_t(i) : -1;
+
+            cache_pos[v]    = pos;
+            float new_score = scores.Vertex(pos, live_tris[v]);
+            float delta     = new_score - vert_score[v];
+            vert_score[v]   = new_score;
+
+            for(uint32_t a = adj_offset[v]; a < adj_offset[v] + live_tris[v]; ++a)
+                tri_score[adj_tris[a]] += delta;
         }
 
-        // Main loop of algorithm
-        while(!faces.empty())
+        best_tri         = -1;
+        float best_score = -1.0f;
+        cache_count      = std::min(new_count, cache_size);
+        for(uint32_t i = 0; i < cache_count; ++i)
         {
-            OptFace * best_face  = nullptr;
-            float     best_score = -1.0f;
+            uint32_t v = new_cache[i];
+            cache[i]   = v;
 
-            // Try to find best scoring face in cache
-            auto itr1 = cache.begin();
-            while(itr1 != cache.end())
+            for(uint32_t a = adj_offset[v]; a < adj_offset[v] + live_tris[v]; ++a)
             {
-                auto itr2 = (*itr1)->faces.begin();
-                while(itr2 != (*itr1)->faces.end())
+                uint32_t t = adj_tris[a];
+                if(tri_score[t] > best_score)
                 {
-                    if((*itr2)->GetScore() > best_score)
-                    {
-                        best_face  = *itr2;
-                        best_score = best_face->GetScore();
-                    }
-                    ++itr2;
+                    best_score = tri_score[t];
+                    best_tri   = t;
                 }
-                ++itr1;
             }
+        }
+    }
 
-            // If that didn't work find it in the complete list of triangles
-            if(best_face == nullptr)
+    indexes.swap(new_index);
+}
+
+// Implementation of Tipsify from Fast Triangle Reordering for Vertex Locality and Reduced Overdraw
+// by Pedro V. Sander, Diego Nehab and Joshua Barczak
+// http://gfx.cs.princeton.edu/pubs/Sander_2007_%3ETR/tipsy.pdf
+// Triangles are emitted in fans around a vertex, the next fan vertex is the candidate that stays
+// in the cache longest after its fan, dead-ends pop recently used vertices or scan in order.
+static void OptimizeTipsify(std::vector<uint32_t> & indexes, size_t num_verts, uint32_t cache_size)
+{
+    uint32_t const num_tris = static_cast<uint32_t>(indexes.size() / 3);
+    if(num_tris == 0 || num_verts == 0)
+        return;
+
+    std::vector<uint32_t> adj_offset, adj_tris;
+    BuildTriangleAdjacency(indexes, num_verts, adj_offset, adj_tris);
+
+    std::vector<uint32_t> live_tris(num_verts);
+    for(size_t v = 0; v < num_verts; ++v)
+        live_tris[v] = adj_offset[v + 1] - adj_offset[v];
+
+    std::vector<uint32_t> cache_time(num_verts, 0);   // time stamp of the vertex entering the cache
+    std::vector<bool>     emitted(num_tris, false);
+    std::vector<uint32_t> dead_end;                   // recently referenced vertices
+    std::vector<uint32_t> candidates;
+
+    std::vector<uint32_t> new_index;
+    new_index.reserve(size_t(num_tris) * 3);
+
+    uint32_t time     = cache_size + 1;
+    size_t   next_vtx = 0;   // dead-end fallback cursor
+    int64_t  fan      = 0;
+    while(fan >= 0)
+    {
+        candidates.clear();
+        for(uint32_t a = adj_offset[fan]; a < adj_offset[fan + 1]; ++a)
+        {
+            uint32_t t = adj_tris[a];
+            if(emitted[t])
+                continue;
+
+            for(int k = 0; k < 3; ++k)
             {
-                auto itr2 = faces.begin();
-                while(itr2 != faces.end())
-                {
-                    if((*itr2).GetScore() > best_score)
-                    {
-                        best_face  = &(*itr2);
-                        best_score = best_face->GetScore();
-                    }
-                    ++itr2;
-                }
+                uint32_t v = indexes[t * 3 + k];
+                new_index.push_back(v);
+                dead_end.push_back(v);
+                candidates.push_back(v);
+                --live_tris[v];
+
+                if(time - cache_time[v] > cache_size)
+                    cache_time[v] = time++;
             }
+            emitted[t] = true;
+        }
+
+        // Candidate with live triangles that remains in the cache after its fan, the oldest one first
+        fan              = -1;
+        int64_t priority = -1;
+        for(uint32_t v : candidates)
+        {
+            if(live_tris[v] == 0)
+                continue;
 
-            // Process vertices of best face
-            for(unsigned int i = 0; i < 3; ++i)
+            int64_t p = 0;
+            if(time - cache_time[v] + 2 * live_tris[v] <= cache_size)
+                p = time - cache_time[v];
+            if(p > priority)
             {
-                // Add vertex to draw list
-                new_index.push_back(best_face->verts[i]->index);
+                priority = p;
+                fan      = v;
+            }
+        }
 
-                // Move vertex to head of cache
-                itr1 = std::find(cache.begin(), cache.end(), best_face->verts[i]);
-                if(itr1 != cache.end())
-                    cache.erase(itr1);
-                cache.push_front(best_face->verts[i]);
+        if(fan >= 0)
+            continue;
 
-                // Remove face from vertex lists
-                best_face->verts[i]->faces.erase(best_face);
-            }
+        while(!dead_end.empty() && fan < 0)
+        {
+            uint32_t v = dead_end.back();
+            dead_end.pop_back();
+            if(live_tris[v] > 0)
+                fan = v;
+        }
+
+        for(; fan < 0 && next_vtx < num_verts; ++next_vtx)
+        {
+            if(live_tris[next_vtx] > 0)
+                fan = next_vtx;
+        }
+    }
+
+    indexes.swap(new_index);
+}
+
+void InternalData::OptimizeIndexOrder(CacheAlgo algo)
+{
+    uint32_t size = std::min<uint32_t>(std::max<uint32_t>(cache_size, 4), maxCacheSize);
+
+    auto optimize = algo == CacheAlgo::TIPSIFY ? OptimizeTipsify : OptimizeForsyth;
+    ThreadPool::Instance().ParallelFor(static_cast<uint32_t>(meshes.size()), [&](uint32_t m) {
+        optimize(meshes[m].indexes, meshes[m].pos.size(), size);
+    });
+}
+
+// Misses of a FIFO cache: a vertex is in the cache while less than cache_size misses followed its own
+static size_t CountCacheMisses(std::vector<uint32_t> const & indexes, size_t num_verts, uint32_t cache_size)
+{
+    std::vector<uint32_t> cache_time(num_verts, 0);
+    uint32_t              time   = cache_size + 1;
+    size_t                misses = 0;
+    for(auto index : indexes)
+    {
+        if(time - cache_time[index] > cache_size)
+        {
+            cache_time[index] = time++;
+            ++misses;
+        }
+    }
 
-            // Remove best face
-            faces.erase(std::find_if(faces.begin(), faces.end(), [&best_face](OptFace const & fc) -> bool {
-                return best_face->id == fc.id;
-            }));
+    return misses;
+}
+
+// Implementation of the overdraw pass from Fast Triangle Reordering for Vertex Locality and Reduced Overdraw
+// by Pedro V. Sander, Diego Nehab and Joshua Barczak. The cache optimized order is split into clusters
+// where the cache is flushed, clusters are subdivided while their ACMR stays within threshold of the
+// whole one, then clusters facing out of the mesh centroid are drawn first.
+static void OptimizeClusterOrder(std::vector<uint32_t> & indexes, std::vector<glm::vec3> const & pos,
+                                 uint32_t cache_size, float threshold)
+{
+    uint32_t const num_tris = static_cast<uint32_t>(indexes.size() / 3);
+    if(num_tris < 2 || pos.empty())
+        return;
 
-            // Update scores of vertices in cache
-            unsigned int cacheIndex = 0;
-            for(itr1 = cache.begin(); itr1 != cache.end(); ++itr1)
+    // FIFO cache simulation, returns misses of triangle t
+    std::vector<uint32_t> cache_time(pos.size(), 0);
+    uint32_t              time       = cache_size + 1;
+    auto                  tri_misses = [&](uint32_t t) {
+        uint32_t misses = 0;
+        for(int k = 0; k < 3; ++k)
+        {
+            uint32_t v = indexes[t * 3 + k];
+            if(time - cache_time[v] > cache_size)
             {
-                (*itr1)->UpdateScore(cacheIndex++);
+                cache_time[v] = time++;
+                ++misses;
             }
+        }
+        return misses;
+    };
+    auto flush_cache = [&]() { time += cache_size + 1; };
+
+    // Hard boundaries: triangles with all vertices missing the cache
+    std::vector<uint32_t> hard(1, 0);
+    for(uint32_t t = 0; t < num_tris; ++t)
+    {
+        if(tri_misses(t) == 3 && t > 0)
+            hard.push_back(t);
+    }
+    hard.push_back(num_tris);
+
+    // Soft boundaries: a new cluster starts once the current one is at most threshold times worse
+    std::vector<uint32_t> clusters;
+    for(size_t h = 0; h + 1 < hard.size(); ++h)
+    {
+        flush_cache();
+        uint32_t misses = 0;
+        for(uint32_t t = hard[h]; t < hard[h + 1]; ++t)
+            misses += tri_misses(t);
+
+        float const max_acmr = threshold * float(misses) / float(hard[h + 1] - hard[h]);
 
-            // Trim cache
-            for(auto i = cache.size(); i > maxCacheSize; --i)
+        flush_cache();
+        uint32_t start = hard[h];
+        misses         = 0;
+        clusters.push_back(start);
+        for(uint32_t t = hard[h]; t < hard[h + 1]; ++t)
+        {
+            misses += tri_misses(t);
+            if(t + 1 < hard[h + 1] && float(misses) / float(t + 1 - start) <= max_acmr)
             {
-                cache.pop_back();
+                flush_cache();
+                start  = t + 1;
+                misses = 0;
+                clusters.push_back(start);
             }
         }
 
-        std::copy(new_index.begin(), new_index.end(), mesh.indexes.begin());
+        // A tail which did not reach max_acmr is merged into the previous cluster
+        if(start != hard[h] && float(misses) / float(hard[h + 1] - start) > max_acmr)
+            clusters.pop_back();
+    }
+    clusters.push_back(num_tris);
+
+    // View independent occlusion potential of clusters
+    glm::vec3 mesh_centroid(0.0f);
+    for(auto const & p : pos)
+        mesh_centroid += p;
+    mesh_centroid /= float(pos.size());
+
+    size_t const       num_clusters = clusters.size() - 1;
+    std::vector<float> potential(num_clusters);
+    for(size_t c = 0; c < num_clusters; ++c)
+    {
+        glm::vec3 centroid(0.0f), normal(0.0f);
+        float     area = 0.0f;
+        for(uint32_t t = clusters[c]; t < clusters[c + 1]; ++t)
+        {
+            glm::vec3 const & p0 = pos[indexes[t * 3 + 0]];
+            glm::vec3 const & p1 = pos[indexes[t * 3 + 1]];
+            glm::vec3 const & p2 = pos[indexes[t * 3 + 2]];
+
+            glm::vec3 n  = glm::cross(p1 - p0, p2 - p0);   // length is twice the area
+            float     a  = glm::length(n);
+            centroid    += (p0 + p1 + p2) * (a / 3.0f);
+            normal      += n;
+            area        += a;
+        }
+
+        if(area > 0.0f)
+            centroid /= area;
+        float len    = glm::length(normal);
+        potential[c] = len > 0.0f ? glm::dot(centroid - mesh_centroid, normal / len) : 0.0f;
     }
+
+    std::vector<uint32_t> order(num_clusters);
+    for(size_t c = 0; c < num_clusters; ++c)
+        order[c] = static_cast<uint32_t>(c);
+    std::stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) { return potential[a] > potential[b]; });
+
+    std::vector<uint32_t> new_index;
+    new_index.reserve(indexes.size());
+    for(uint32_t c : order)
+        new_index.insert(new_index.end(), indexes.begin() + size_t(clusters[c]) * 3,
+                         indexes.begin() + size_t(clusters[c + 1]) * 3);
+
+    // Clusters start with the cache left by their new predecessors, the bound is checked on the result
+    size_t before = CountCacheMisses(indexes, pos.size(), cache_size);
+    size_t after  = CountCacheMisses(new_index, pos.size(), cache_size);
+    if(float(after) <= threshold * float(before))
+        indexes.swap(new_index);
+}
+
+void InternalData::OptimizeOverdraw(float threshold)
+{
+    uint32_t size = std::min<uint32_t>(std::max<uint32_t>(cache_size, 4), maxCacheSize);
+
+    ThreadPool::Instance().ParallelFor(static_cast<uint32_t>(meshes.size()), [&](uint32_t m) {
+        OptimizeClusterOrder(meshes[m].indexes, meshes[m].pos, size, std::max(threshold, 1.0f));
+    });
+}
+
+unsigned int InternalData::OptimizeVertexFetch()
+{
+    std::vector<unsigned int> num_dropped(meshes.size(), 0);
+
+    ThreadPool::Instance().ParallelFor(static_cast<uint32_t>(meshes.size()), [&](uint32_t m) {
+        SubMesh & mesh = meshes[m];
+
+        // Vertices are renumbered in order of the first reference, unreferenced ones are dropped
+        uint32_t const        none = std::numeric_limits<uint32_t>::max();
+        std::vector<uint32_t> remap(mesh.pos.size(), none);
+        uint32_t              count = 0;
+        for(auto & index : mesh.indexes)
+        {
+            if(remap[index] == none)
+                remap[index] = count++;
+            index = remap[index];
+        }
+
+        RemapVertices(mesh, remap, count);
+        num_dropped[m] = static_cast<unsigned int>(remap.size() - count);
+    });
+
+    unsigned int total = 0;
+    for(auto num : num_dropped)
+        total += num;
+
+    return total;
 }
 
-float InternalData::CalcCacheEfficiency() const
+InternalData::CacheStats InternalData::CalcCacheEfficiency() const
 {
-    float        atvr = 0.0f;
-    unsigned int i    = 0;
+    size_t num_tris  = 0;
+    size_t num_verts = 0;
+    size_t misses    = 0;
     for(auto & mesh : meshes)
     {
-        unsigned int            misses = 0;
-        std::list<unsigned int> test_cache;
+        misses += CountCacheMisses(mesh.indexes, mesh.pos.size(), cache_size);
+
+        std::vector<bool> used(mesh.pos.size(), false);
         for(auto index : mesh.indexes)
         {
-            if(std::find(test_cache.begin(), test_cache.end(), index) == test_cache.end())
+            if(!used[index])
             {
-                test_cache.push_back(index);
-                if(test_cache.size() > maxCacheSize)
-                    test_cache.erase(test_cache.begin());
-                ++misses;
+                used[index] = true;
+                ++num_verts;
             }
         }
 
-        // Average transform to vertex ratio (ATVR)
-        // 1.0 is theoretical optimum, meaning that each vertex is just transformed exactly one time
-        atvr += (float)(mesh.indexes.size() + misses) / mesh.indexes.size();
-        i++;
+        num_tris += mesh.indexes.size() / 3;
+    }
+
+    CacheStats stats;
+    stats.acmr = num_tris > 0 ? float(misses) / num_tris : 0.0f;
+    stats.atvr = num_verts > 0 ? float(misses) / num_verts : 0.0f;
+
+    return stats;
+}
+
+//===========================================================================//
+
+// Rigid transform, rotation is applied first
+struct RigidTransform
+{
+    glm::quat rot;
+    glm::vec3 trans;
+
+    glm::vec3      operator*(glm::vec3 const & p) const { return rot * p + trans; }
+    RigidTransform operator*(RigidTransform const & b) const { return {rot * b.rot, trans + rot * b.trans}; }
+};
+
+// Normalized lerp along the shortest arc, the runtime has to interpolate the same way
+static glm::quat Nlerp(glm::quat const & a, glm::quat b, float u)
+{
+    if(glm::dot(a, b) < 0.0f)
+        b = -b;
+
+    return glm::normalize(a * (1.0f - u) + b * u);
+}
+
+// Greedy key selection: the next key is placed on the farthest frame segment_ok(key, frame) accepts.
+// The segment end is found by exponential and then binary search, the first and the last frames are keys.
+template<typename SegmentOk>
+static std::vector<uint32_t> SelectKeys(uint32_t num_frames, SegmentOk segment_ok)
+{
+    std::vector<uint32_t> keys(1, 0);
+    for(uint32_t key = 0; key + 1 < num_frames; key = keys.back())
+    {
+        uint32_t good = key + 1;   // neighbour frames have nothing to interpolate
+        uint32_t bad  = num_frames;
+        for(uint32_t step = 1; good + step < num_frames; step *= 2)
+        {
+            if(!segment_ok(key, good + step))
+            {
+                bad = good + step;
+                break;
+            }
+            good += step;
+        }
+
+        while(bad - good > 1)
+        {
+            uint32_t mid = good + (bad - good) / 2;
+            if(segment_ok(key, mid))
+                good = mid;
+            else
+                bad = mid;
+        }
+
+        keys.push_back(good);
+    }
+
+    return keys;
+}
+
+void InternalData::ReduceKeyframes(bool relative, float rot_error, float trans_error)
+{
+    uint32_t const count = static_cast<uint32_t>(joints.size());
+    if(num_frames < 3 || count == 0)
+        return;
+
+    // Zero error keeps only the keys which are exactly redundant
+    float const min_cos  = std::cos(std::max(rot_error, FLOATEPSILON) * 0.5f);
+    float const max_dist = std::max(trans_error, FLOATEPSILON);
+
+    auto valid_track = [relative](JointNode const & jnt) {
+        return relative ? !jnt.r_rot.empty() && !jnt.r_trans.empty() : !jnt.a_rot.empty() && !jnt.a_trans.empty();
+    };
+
+    // Parents are reduced before their children, joints of one level are independent
+    std::vector<std::vector<uint32_t>> children(count);
+    std::vector<std::vector<uint32_t>> levels;
+    for(uint32_t j = 0; j < count; ++j)
+    {
+        uint32_t depth = 0;
+        for(uint32_t p = joints[j].parent; p > 0 && p <= count && depth <= count; p = joints[p - 1].parent)
+            ++depth;
+
+        if(depth > count)
+        {
+            std::stringstream ss;
+            ss << "Cyclic joint hierarchy: " << joints[j].name;
+
+            throw std::runtime_error(ss.str());
+        }
+
+        if(levels.size() <= depth)
+            levels.resize(depth + 1);
+        levels[depth].push_back(j);
+
+        if(joints[j].parent > 0 && joints[j].parent <= count)
+            children[joints[j].parent - 1].push_back(j);
+    }
+
+    // Model space transforms of the source and the reduced tracks, only relative tracks are chained
+    std::vector<std::vector<RigidTransform>> exact(count), reduced(count);
+
+    // Points whose model space error is bounded by trans_error: the joint origin and its children
+    // offsets, absolute tracks map bind space positions
+    std::vector<glm::vec3> bind_pos(count);
+    for(uint32_t j = 0; j < count; ++j)
+        bind_pos[j] = glm::vec3(glm::inverse(joints[j].inverse_bind)[3]);
+
+    for(auto const & level : levels)
+    {
+        ThreadPool::Instance().ParallelFor(static_cast<uint32_t>(level.size()), [&](uint32_t l) {
+            uint32_t    j   = level[l];
+            JointNode & jnt = joints[j];
+            jnt.rot_keys.clear();
+            jnt.trans_keys.clear();
+
+            uint32_t p = relative && jnt.parent > 0 && jnt.parent <= count ? jnt.parent : 0;
+            if(!valid_track(jnt) || (p > 0 && reduced[p - 1].empty()))
+                return;
+
+            Track<glm::quat> const & rot   = relative ? jnt.r_rot : jnt.a_rot;
+            Track<glm::vec3> const & trans = relative ? jnt.r_trans : jnt.a_trans;
+
+            RigidTransform const identity = {glm::quat(1.0f, 0.0f, 0.0f, 0.0f), glm::vec3(0.0f)};
+            auto parent_exact   = [&](uint32_t f) { return p > 0 ? exact[p - 1][f] : identity; };
+            auto parent_reduced = [&](uint32_t f) { return p > 0 ? reduced[p - 1][f] : identity; };
+
+            std::vector<glm::vec3> points;
+            auto frame_ok = [&](uint32_t f, RigidTransform const & local) {
+                RigidTransform src = parent_exact(f) * RigidTransform{rot[f], trans[f]};
+                RigidTransform dst = parent_reduced(f) * local;
+                if(std::abs(glm::dot(src.rot, dst.rot)) < min_cos)
+                    return false;
+
+                points.clear();
+                points.push_back(relative ? glm::vec3(0.0f) : bind_pos[j]);
+                for(uint32_t c : children[j])
+                {
+                    if(!relative)
+                        points.push_back(bind_pos[c]);
+                    else if(valid_track(joints[c]))
+                        points.push_back(joints[c].r_trans[f]);
+                }
+
+                for(auto const & pt : points)
+                {
+                    if(glm::distance(src * pt, dst * pt) > max_dist)
+                        return false;
+                }
+
+                return true;
+            };
+
+            // Rotation is reduced against the source translation, then translation against the reduced rotation.
+            // Identity and constant channels are exact without keys, the end keys only drive the reconstruction
+            std::vector<uint32_t> const end_keys = {0, num_frames - 1};
+
+            std::vector<uint32_t> rot_keys = end_keys;
+            if(rot.type == TrackType::ANIMATED)
+                rot_keys = SelectKeys(num_frames, [&](uint32_t a, uint32_t b) {
+                    for(uint32_t f = a + 1; f < b; ++f)
+                    {
+                        float u = float(f - a) / float(b - a);
+                        if(!frame_ok(f, RigidTransform{Nlerp(rot[a], rot[b], u), trans[f]}))
+                            return false;
+                    }
+                    return true;
+                });
+
+            std::vector<glm::quat> reduced_rot(num_frames);
+            for(size_t k = 0; k + 1 < rot_keys.size(); ++k)
+            {
+                uint32_t a = rot_keys[k], b = rot_keys[k + 1];
+                for(uint32_t f = a; f <= b; ++f)
+                    reduced_rot[f] = Nlerp(rot[a], rot[b], float(f - a) / float(b - a));
+            }
+
+            std::vector<uint32_t> trans_keys = end_keys;
+            if(trans.type == TrackType::ANIMATED)
+                trans_keys = SelectKeys(num_frames, [&](uint32_t a, uint32_t b) {
+                    for(uint32_t f = a + 1; f < b; ++f)
+                    {
+                        float u = float(f - a) / float(b - a);
+                        if(!frame_ok(f, RigidTransform{reduced_rot[f], trans[a] + (trans[b] - trans[a]) * u}))
+                            return false;
+                    }
+                    return true;
+                });
+
+            if(rot.type == TrackType::ANIMATED)
+                jnt.rot_keys = rot_keys;
+            if(trans.type == TrackType::ANIMATED)
+                jnt.trans_keys = trans_keys;
+
+            if(!relative)
+                return;
+
+            // Children are measured against the reduced transforms, parent error is not compensated by them
+            exact[j].resize(num_frames);
+            reduced[j].resize(num_frames);
+            for(size_t k = 0; k + 1 < trans_keys.size(); ++k)
+            {
+                uint32_t a = trans_keys[k], b = trans_keys[k + 1];
+                for(uint32_t f = a; f <= b; ++f)
+                {
+                    glm::vec3 t   = trans[a] + (trans[b] - trans[a]) * (float(f - a) / float(b - a));
+                    exact[j][f]   = parent_exact(f) * RigidTransform{rot[f], trans[f]};
+                    reduced[j][f] = parent_reduced(f) * RigidTransform{reduced_rot[f], t};
+                }
+            }
+        });
     }
+}
 
-    return atvr / i;
+// Animated track value at new frame k is interpolated at source frame k * step
+template<typename T, typename Interpolate>
+static void ResampleTrack(InternalData::Track<T> & track, uint32_t num_frames, uint32_t new_frames, float step,
+                          Interpolate interpolate)
+{
+    if(track.type != InternalData::TrackType::ANIMATED)
+        return;
+
+    std::vector<T> frames(new_frames);
+    for(uint32_t k = 0; k < new_frames; ++k)
+    {
+        float    pos = k * step;
+        uint32_t i   = std::min(static_cast<uint32_t>(pos), num_frames - 2);
+        frames[k]    = interpolate(track.values[i], track.values[i + 1], std::min(pos - i, 1.0f));
+    }
+
+    track.Assign(std::move(frames));
+}
+
+void InternalData::ResampleAnimation(float fps)
+{
+    if(num_frames < 2 || duration <= 0.0f || fps <= 0.0f)
+        return;
+
+    // The first and the last frames are kept, so the clip spans new_frames - 1 intervals
+    uint32_t new_frames = std::max(2u, static_cast<uint32_t>(std::lround(duration * fps)) + 1u);
+    if(new_frames == num_frames)
+        return;
+
+    float step = float(num_frames - 1) / float(new_frames - 1);
+
+    auto slerp = [](glm::quat const & a, glm::quat const & b, float u) { return glm::slerp(a, b, u); };
+    auto lerp  = [](glm::vec3 const & a, glm::vec3 const & b, float u) { return a + (b - a) * u; };
+
+    ThreadPool::Instance().ParallelFor(static_cast<uint32_t>(joints.size()), [&](uint32_t j) {
+        JointNode & jnt = joints[j];
+        ResampleTrack(jnt.a_rot, num_frames, new_frames, step, slerp);
+        ResampleTrack(jnt.a_trans, num_frames, new_frames, step, lerp);
+        ResampleTrack(jnt.r_rot, num_frames, new_frames, step, slerp);
+        ResampleTrack(jnt.r_trans, num_frames, new_frames, step, lerp);
+
+        jnt.rot_keys.clear();
+        jnt.trans_keys.clear();
+    });
+
+    num_frames = new_frames;
+    frame_rate = (new_frames - 1) / duration;
+
+    // Rebuilt by CalculateBBoxes for the new frames
+    bboxes.clear();
 }
 
 //===========================================================================//
@@ -345,7 +1054,40 @@ void InternalData::CompleteVertexData(uint32_t tex_channnel)
         CalculateTangentSpace(tex_channnel);
 }
 
-void InternalData::CalculateBBoxes()
+// Skinning matrix of joint for frame
+static glm::mat4 TrackMatrix(glm::quat const & rot, glm::vec3 const & trans)
+{
+    glm::mat4 mt = glm::mat4_cast(rot);
+    return glm::column(mt, 3, glm::vec4(trans, 1.0f));
+}
+
+// Skinning matrices of all joints in a frame: the absolute tracks when they are exported,
+// otherwise the relative tracks chained down the hierarchy (parents precede their children)
+static void JointFrameMatrices(std::vector<InternalData::JointNode> const & joints, uint32_t frame,
+                               std::vector<glm::mat4> & model, std::vector<glm::mat4> & skin)
+{
+    model.resize(joints.size());
+    skin.resize(joints.size());
+    for(size_t j = 0; j < joints.size(); ++j)
+    {
+        InternalData::JointNode const & jnt = joints[j];
+        if(!jnt.a_rot.empty())
+        {
+            skin[j] = TrackMatrix(jnt.a_rot[frame], jnt.a_trans[frame]);
+            continue;
+        }
+
+        glm::mat4 local = jnt.r_rot.empty() ? glm::mat4(1.0f) : TrackMatrix(jnt.r_rot[frame], jnt.r_trans[frame]);
+        if(jnt.parent > 0 && jnt.parent <= j)
+            MulMat4(model[jnt.parent - 1], local, model[j]);
+        else
+            model[j] = local;
+
+        MulMat4(model[j], jnt.inverse_bind, skin[j]);
+    }
+}
+
+void InternalData::CalculateBBoxes(bool exact)
 {
     for(auto & msh : meshes)
     {
@@ -353,30 +1095,96 @@ void InternalData::CalculateBBoxes()
             msh.bbox.buildBoundBox(msh.pos);
     }
 
-    bboxes.clear();
-    for(unsigned int i = 0; i < num_frames; ++i)
+    bboxes.assign(num_frames, AABB());
+    if(num_frames == 0)
+        return;
+
+    auto valid_joint = [this](Weight const & weight) {
+        return weight.joint_index > 0 && weight.joint_index <= joints.size();
+    };
+
+    if(exact && !joints.empty())
+    {
+        // Skin every vertex in every frame, meshes without weights are not skinned
+        std::vector<SkinData> skins(meshes.size());
+        for(size_t m = 0; m < meshes.size(); ++m)
+        {
+            if(meshes[m].weights.size() == meshes[m].pos.size())
+            {
+                auto joint_of = [&](Weight const & weight, uint32_t & joint) {
+                    joint = weight.joint_index - 1;
+                    return valid_joint(weight);
+                };
+                skins[m] = BuildSkinData(meshes[m].pos, meshes[m].weights, joint_of);
+            }
+        }
+
+        ThreadPool::Instance().ParallelFor(num_frames, [&](uint32_t i) {
+            std::vector<glm::mat4> model, skin;
+            JointFrameMatrices(joints, i, model, skin);
+
+            std::vector<SkinMatrix> matrices(joints.size());
+            for(size_t j = 0; j < joints.size(); ++j)
+                matrices[j] = SkinMatrix(skin[j]);
+
+            for(size_t m = 0; m < meshes.size(); ++m)
+            {
+                if(meshes[m].weights.size() == meshes[m].pos.size())
+                    bboxes[i].expandBy(SkinnedBounds(skins[m], matrices.data()));
+                else
+                    bboxes[i].expandBy(meshes[m].bbox);
+            }
+        });
+
+        return;
+    }
+
+    // Bind space bounds of the vertices influenced by every joint. A skinned vertex is a convex
+    // combination of its positions transformed by the joints, so the union of the transformed
+    // joint bounds contains it (for normalized weights).
+    std::vector<AABB> joint_bounds(joints.size());
+    std::vector<bool> influence(joints.size(), false);
+    AABB              static_box;   // not skinned meshes, vertices without weights are skinned to the origin
+
+    for(auto & msh : meshes)
     {
-        std::vector<glm::vec3> new_pos_vec;
+        if(msh.weights.size() != msh.pos.size())
+        {
+            static_box.expandBy(msh.bbox);
+            continue;
+        }
 
-        for(auto & msh : meshes)
+        for(unsigned int j = 0; j < msh.pos.size(); ++j)
         {
-            for(unsigned int j = 0; j < msh.pos.size(); ++j)
+            if(msh.weights[j].empty())
+                static_box.expandBy(glm::vec3(0.0f));
+
+            for(auto & weight : msh.weights[j])
             {
-                glm::mat4 mat_tr(0.0f);
-                for(auto & weight : msh.weights[j])
+                if(weight.w > 0.0f && valid_joint(weight))
                 {
-                    glm::mat4 mt = glm::mat4_cast(joints[weight.joint_index - 1].a_rot[i]);
-                    mt = glm::column(mt, 3, glm::vec4(joints[weight.joint_index - 1].a_trans[i], 1.0f));
-
-                    mat_tr += weight.w * mt;
+                    joint_bounds[weight.joint_index - 1].expandBy(msh.pos[j]);
+                    influence[weight.joint_index - 1] = true;
                 }
-
-                glm::vec4 cpos = mat_tr * glm::vec4(msh.pos[j], 1.0);
-                new_pos_vec.push_back(glm::vec3(cpos));
             }
         }
-        AABB temp;
-        temp.buildBoundBox(new_pos_vec);
-        bboxes.push_back(temp);
     }
+
+    ThreadPool::Instance().ParallelFor(num_frames, [&](uint32_t i) {
+        std::vector<glm::mat4> model, skin;
+        JointFrameMatrices(joints, i, model, skin);
+
+        AABB frame_box = static_box;
+        for(size_t j = 0; j < joints.size(); ++j)
+        {
+            if(!influence[j])
+                continue;
+
+            AABB bb = joint_bounds[j];
+            bb.transform(skin[j]);
+            frame_box.expandBy(bb);
+        }
+
+        bboxes[i] = frame_box;
+    });
 }
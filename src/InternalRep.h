@@ -21,17 +21,42 @@ struct InternalData
     };
     using WeightsVec = std::vector<Weight>;
 
+    //! Kind of a joint animation channel, only animated channels store a value per frame
+    enum class TrackType : uint8_t
+    {
+        IDENTITY,   // identity in every frame
+        CONSTANT,   // one value for all frames
+        ANIMATED    // values.size() == num_frames
+    };
+
+    //! Rotation or translation channel of a joint
+    template<typename T>
+    struct Track
+    {
+        TrackType      type = TrackType::IDENTITY;
+        std::vector<T> values;   // one value unless animated, empty - no animation
+
+        bool      empty() const { return values.empty(); }
+        T const & operator[](size_t frame) const { return type == TrackType::ANIMATED ? values[frame] : values[0]; }
+
+        //! Classify and store per frame values, identity and constant channels keep one value
+        void Assign(std::vector<T> && frames);
+    };
+
     struct JointNode
     {
         uint32_t    parent;
         uint32_t    index;
         std::string name;
 
-        std::vector<glm::quat> a_rot;     // absolute transform matrix for animation
-        std::vector<glm::vec3> a_trans;   // vec.size() == numFrames
+        Track<glm::quat> a_rot;     // absolute transform matrix for animation
+        Track<glm::vec3> a_trans;
 
-        std::vector<glm::quat> r_rot;   // relative transform matrix for animation
-        std::vector<glm::vec3> r_trans;
+        Track<glm::quat> r_rot;   // relative transform matrix for animation
+        Track<glm::vec3> r_trans;
+
+        std::vector<uint32_t> rot_keys;     // key frames of the reduced animated rotation and translation tracks,
+        std::vector<uint32_t> trans_keys;   // empty - a key in every frame
 
         glm::mat4 inverse_bind;
     };
@@ -60,12 +85,37 @@ struct InternalData
         std::string tex_name;
     };
 
-    static int const maxCacheSize = 16;
+    //! Vertex cache optimization algorithms
+    enum class CacheAlgo
+    {
+        FORSYTH,   // Tom Forsyth, Linear-Speed Vertex Cache Optimisation
+        TIPSIFY    // Sander et al., Fast Triangle Reordering for Vertex Locality and Reduced Overdraw
+    };
+
+    //! Post-transform vertex cache statistics of the index order, FIFO cache of cache_size entries
+    struct CacheStats
+    {
+        float acmr;   // average cache miss ratio: transformed vertices per triangle, ~0.5 at best
+        float atvr;   // average transform to vertex ratio: transformed vertices per vertex, 1.0 at best
+    };
+
+    //! Triangles and vertices removed by RemoveDegeneratedTriangles
+    struct CleanupStats
+    {
+        unsigned int degenerate_tris;   // zero area
+        unsigned int duplicate_tris;    // same vertices in the same winding as an earlier triangle
+        unsigned int unused_verts;      // not referenced by the kept triangles
+    };
+
+    static constexpr uint32_t maxCacheSize = 64;   // upper bound of cache_size
 
     std::vector<JointNode> joints;
     std::vector<AABB>      bboxes;
     uint32_t               num_frames;
     float                  frame_rate;
+    float                  duration;   // clip length in seconds, frames are spread evenly over it
+
+    uint32_t cache_size;   // post-transform vertex cache entries the index order is optimized for
 
     std::vector<SubMesh>  meshes;
     std::vector<Material> materials;
@@ -74,15 +124,19 @@ struct InternalData
     virtual ~InternalData() = default;
 
     // Optimizations
-    unsigned int RemoveDegeneratedTriangles();
-    void         OptimizeIndexOrder();
-    float        CalcCacheEfficiency() const;
+    CleanupStats RemoveDegeneratedTriangles();
+    void         OptimizeIndexOrder(CacheAlgo algo = CacheAlgo::FORSYTH);
+    void         OptimizeOverdraw(float threshold = 1.05f);
+    unsigned int OptimizeVertexFetch();
+    CacheStats   CalcCacheEfficiency() const;
+    void         ReduceKeyframes(bool relative, float rot_error, float trans_error);
+    void         ResampleAnimation(float fps);
 
     // Additional calculations
     void CalculateNormals();
     void CalculateTangentSpace(uint32_t tex_channnel = 0);
     void CompleteVertexData(uint32_t tex_channnel = 0);
-    void CalculateBBoxes();
+    void CalculateBBoxes(bool exact = false);
 };
 
 #endif   // INTERNALREP_H
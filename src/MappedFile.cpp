@@ -0,0 +1,105 @@
+#include "MappedFile.h"
+#include <sstream>
+#include <stdexcept>
+
+#ifdef _WIN32
+#    define WIN32_LEAN_AND_MEAN
+#    include <windows.h>
+#else
+#    include <fcntl.h>
+#    include <sys/mman.h>
+#    include <sys/stat.h>
+#    include <unistd.h>
+#endif
+
+static void ThrowMapError(std::string const & fname, char const * what)
+{
+    std::stringstream ss;
+    ss << "Error file: " << fname << " " << what << std::endl;
+
+    throw std::runtime_error(ss.str());
+}
+
+#ifdef _WIN32
+MappedFile::MappedFile(std::string const & fname, Mode mode) :
+    m_data(nullptr), m_size(0), m_mode(mode), m_file(INVALID_HANDLE_VALUE), m_mapping(nullptr)
+{
+    m_file = CreateFileA(fname.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                         FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if(m_file == INVALID_HANDLE_VALUE)
+        ThrowMapError(fname, "not open!");
+
+    LARGE_INTEGER size;
+    if(!GetFileSizeEx(m_file, &size))
+    {
+        CloseHandle(m_file);
+        ThrowMapError(fname, "size unknown!");
+    }
+    m_size = static_cast<size_t>(size.QuadPart);
+
+    // Empty file can't be mapped
+    if(m_size == 0)
+        return;
+
+    bool cow  = mode == Mode::CopyOnWrite;
+    m_mapping = CreateFileMappingA(m_file, nullptr, cow ? PAGE_WRITECOPY : PAGE_READONLY, 0, 0, nullptr);
+    if(m_mapping != nullptr)
+        m_data = static_cast<char *>(MapViewOfFile(m_mapping, cow ? FILE_MAP_COPY : FILE_MAP_READ, 0, 0, 0));
+
+    if(m_data == nullptr)
+    {
+        if(m_mapping != nullptr)
+            CloseHandle(m_mapping);
+        CloseHandle(m_file);
+        ThrowMapError(fname, "not mapped!");
+    }
+}
+
+MappedFile::~MappedFile()
+{
+    if(m_data != nullptr)
+        UnmapViewOfFile(m_data);
+    if(m_mapping != nullptr)
+        CloseHandle(m_mapping);
+    if(m_file != INVALID_HANDLE_VALUE)
+        CloseHandle(m_file);
+}
+#else
+MappedFile::MappedFile(std::string const & fname, Mode mode) : m_data(nullptr), m_size(0), m_mode(mode)
+{
+    int fd = open(fname.c_str(), O_RDONLY);
+    if(fd == -1)
+        ThrowMapError(fname, "not open!");
+
+    struct stat st;
+    if(fstat(fd, &st) == -1)
+    {
+        close(fd);
+        ThrowMapError(fname, "size unknown!");
+    }
+    m_size = static_cast<size_t>(st.st_size);
+
+    // Empty file can't be mapped
+    if(m_size == 0)
+    {
+        close(fd);
+        return;
+    }
+
+    int    prot = mode == Mode::CopyOnWrite ? PROT_READ | PROT_WRITE : PROT_READ;
+    void * ptr  = mmap(nullptr, m_size, prot, MAP_PRIVATE, fd, 0);
+    close(fd);   // mapping keeps the file referenced
+
+    if(ptr == MAP_FAILED)
+        ThrowMapError(fname, "not mapped!");
+
+    m_data = static_cast<char *>(ptr);
+    madvise(m_data, m_size, MADV_SEQUENTIAL);
+}
+
+MappedFile::~MappedFile()
+{
+    if(m_data != nullptr)
+        munmap(m_data, m_size);
+}
+#endif
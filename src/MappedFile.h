@@ -0,0 +1,52 @@
+#ifndef MAPPEDFILE_H
+#define MAPPEDFILE_H
+
+#include <cassert>
+#include <cstddef>
+#include <string>
+
+//! Memory mapping of a whole file
+/*!
+    The file content is accessed directly from the page cache, without copying
+    it into a private buffer. The data is not null terminated.
+    In CopyOnWrite mode the mapping is writable, only modified pages get private
+    copies and the file itself is never changed (in-situ parsers write into the text).
+*/
+class MappedFile
+{
+public:
+    enum class Mode
+    {
+        ReadOnly,
+        CopyOnWrite,
+    };
+
+private:
+    char * m_data;
+    size_t m_size;
+    Mode   m_mode;
+#ifdef _WIN32
+    void * m_file;
+    void * m_mapping;
+#endif
+
+public:
+    //! Map file, throws std::runtime_error if the file can't be opened or mapped
+    explicit MappedFile(std::string const & fname, Mode mode = Mode::ReadOnly);
+    ~MappedFile();
+
+    MappedFile(MappedFile const &) = delete;
+    MappedFile & operator=(MappedFile const &) = delete;
+
+    char const * Data() const { return m_data; }
+    size_t       Size() const { return m_size; }
+
+    //! Writable data, CopyOnWrite mode only
+    char * MutableData()
+    {
+        assert(m_mode == Mode::CopyOnWrite);
+        return m_data;
+    }
+};
+
+#endif   // MAPPEDFILE_H
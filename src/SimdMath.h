@@ -0,0 +1,45 @@
+#ifndef SIMDMATH_H
+#define SIMDMATH_H
+
+#include <glm/glm.hpp>
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#    include <xmmintrin.h>
+#    define SIMD_MATH_SSE
+#endif
+
+//! out = a * b, out may be the same matrix as a or b
+/*!
+    glm::mat4 is column major: every column of the result is a linear combination
+    of the columns of a, weighted by the elements of the matching column of b.
+*/
+inline void MulMat4(glm::mat4 const & a, glm::mat4 const & b, glm::mat4 & out)
+{
+#ifdef SIMD_MATH_SSE
+    float const * pa = &a[0][0];
+    float const * pb = &b[0][0];
+
+    __m128 a0 = _mm_loadu_ps(pa + 0);
+    __m128 a1 = _mm_loadu_ps(pa + 4);
+    __m128 a2 = _mm_loadu_ps(pa + 8);
+    __m128 a3 = _mm_loadu_ps(pa + 12);
+
+    __m128 r[4];
+    for(int j = 0; j < 4; ++j)
+    {
+        __m128 c = _mm_mul_ps(a0, _mm_set1_ps(pb[j * 4 + 0]));
+        c        = _mm_add_ps(c, _mm_mul_ps(a1, _mm_set1_ps(pb[j * 4 + 1])));
+        c        = _mm_add_ps(c, _mm_mul_ps(a2, _mm_set1_ps(pb[j * 4 + 2])));
+        c        = _mm_add_ps(c, _mm_mul_ps(a3, _mm_set1_ps(pb[j * 4 + 3])));
+        r[j]     = c;
+    }
+
+    float * po = &out[0][0];
+    for(int j = 0; j < 4; ++j)
+        _mm_storeu_ps(po + j * 4, r[j]);
+#else
+    out = a * b;
+#endif
+}
+
+#endif   // SIMDMATH_H
@@ -0,0 +1,149 @@
+#include "Skinning.h"
+#include "SimdMath.h"
+
+SkinMatrix::SkinMatrix(glm::mat4 const & mat)
+{
+    // glm::mat4 is column major, rows are stored here
+    for(int r = 0; r < 3; ++r)
+    {
+        for(int c = 0; c < 4; ++c)
+            m[r * 4 + c] = mat[c][r];
+    }
+}
+
+// Skinned position of vertex v
+static inline glm::vec3 SkinVertex(SkinData const & skin, SkinMatrix const * matrices, size_t v)
+{
+    float acc[12] = {};
+    for(uint32_t k = 0; k < skin.max_influences; ++k)
+    {
+        size_t i = k * size_t(skin.num_vertices) + v;
+        float  w = skin.weights[i];
+        if(w == 0.0f)
+            continue;
+
+        float const * m = matrices[skin.joints[i]].m;
+        for(int e = 0; e < 12; ++e)
+            acc[e] += w * m[e];
+    }
+
+    float x = skin.x[v], y = skin.y[v], z = skin.z[v];
+    return glm::vec3(acc[0] * x + acc[1] * y + acc[2] * z + acc[3], acc[4] * x + acc[5] * y + acc[6] * z + acc[7],
+                     acc[8] * x + acc[9] * y + acc[10] * z + acc[11]);
+}
+
+#ifdef SIMD_MATH_SSE
+// Skinned positions of vertices [v, v + 4), one vertex per lane
+static inline void SkinVertices4(SkinData const & skin, SkinMatrix const * matrices, size_t v, __m128 & ox,
+                                 __m128 & oy, __m128 & oz)
+{
+    size_t n = skin.num_vertices;
+
+    // Blended matrices of the four vertices, element e of all of them in acc[e]
+    __m128 acc[12];
+    for(int e = 0; e < 12; ++e)
+        acc[e] = _mm_setzero_ps();
+
+    for(uint32_t k = 0; k < skin.max_influences; ++k)
+    {
+        size_t i = k * n + v;
+        __m128 w = _mm_loadu_ps(&skin.weights[i]);
+
+        float const * m0 = matrices[skin.joints[i + 0]].m;
+        float const * m1 = matrices[skin.joints[i + 1]].m;
+        float const * m2 = matrices[skin.joints[i + 2]].m;
+        float const * m3 = matrices[skin.joints[i + 3]].m;
+
+        for(int e = 0; e < 12; ++e)
+            acc[e] = _mm_add_ps(acc[e], _mm_mul_ps(w, _mm_setr_ps(m0[e], m1[e], m2[e], m3[e])));
+    }
+
+    __m128 x = _mm_loadu_ps(&skin.x[v]);
+    __m128 y = _mm_loadu_ps(&skin.y[v]);
+    __m128 z = _mm_loadu_ps(&skin.z[v]);
+
+    __m128 r[3];
+    for(int row = 0; row < 3; ++row)
+    {
+        __m128 const * a = acc + row * 4;
+        r[row]           = _mm_add_ps(_mm_add_ps(_mm_mul_ps(a[0], x), _mm_mul_ps(a[1], y)),
+                                      _mm_add_ps(_mm_mul_ps(a[2], z), a[3]));
+    }
+
+    ox = r[0];
+    oy = r[1];
+    oz = r[2];
+}
+#endif
+
+void SkinPositions(SkinData const & skin, SkinMatrix const * matrices, float * out_x, float * out_y, float * out_z)
+{
+    size_t v = 0;
+
+#ifdef SIMD_MATH_SSE
+    for(; v + 4 <= skin.num_vertices; v += 4)
+    {
+        __m128 x, y, z;
+        SkinVertices4(skin, matrices, v, x, y, z);
+
+        _mm_storeu_ps(out_x + v, x);
+        _mm_storeu_ps(out_y + v, y);
+        _mm_storeu_ps(out_z + v, z);
+    }
+#endif
+
+    for(; v < skin.num_vertices; ++v)
+    {
+        glm::vec3 pos = SkinVertex(skin, matrices, v);
+
+        out_x[v] = pos.x;
+        out_y[v] = pos.y;
+        out_z[v] = pos.z;
+    }
+}
+
+AABB SkinnedBounds(SkinData const & skin, SkinMatrix const * matrices)
+{
+    AABB   bbox;
+    size_t v = 0;
+
+#ifdef SIMD_MATH_SSE
+    if(skin.num_vertices >= 4)
+    {
+        __m128 min_x = _mm_set1_ps(max_float), min_y = min_x, min_z = min_x;
+        __m128 max_x = _mm_set1_ps(min_float), max_y = max_x, max_z = max_x;
+
+        for(; v + 4 <= skin.num_vertices; v += 4)
+        {
+            __m128 x, y, z;
+            SkinVertices4(skin, matrices, v, x, y, z);
+
+            min_x = _mm_min_ps(min_x, x);
+            min_y = _mm_min_ps(min_y, y);
+            min_z = _mm_min_ps(min_z, z);
+            max_x = _mm_max_ps(max_x, x);
+            max_y = _mm_max_ps(max_y, y);
+            max_z = _mm_max_ps(max_z, z);
+        }
+
+        float lo[3][4], hi[3][4];
+        _mm_storeu_ps(lo[0], min_x);
+        _mm_storeu_ps(lo[1], min_y);
+        _mm_storeu_ps(lo[2], min_z);
+        _mm_storeu_ps(hi[0], max_x);
+        _mm_storeu_ps(hi[1], max_y);
+        _mm_storeu_ps(hi[2], max_z);
+
+        for(int l = 0; l < 4; ++l)
+        {
+            bbox.expandBy(glm::vec3(lo[0][l], lo[1][l], lo[2][l]));
+            bbox.expandBy(glm::vec3(hi[0][l], hi[1][l], hi[2][l]));
+        }
+    }
+#endif
+
+    for(; v < skin.num_vertices; ++v)
+        bbox.expandBy(SkinVertex(skin, matrices, v));
+
+    return bbox;
+}
@@ -0,0 +1,87 @@
+#ifndef SKINNING_H
+#define SKINNING_H
+
+#include "AABB.h"
+#include <algorithm>
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <vector>
+
+//! Affine skinning matrix, 3 rows of 4 floats (the last row is always 0 0 0 1)
+struct SkinMatrix
+{
+    float m[12];
+
+    SkinMatrix() = default;
+    explicit SkinMatrix(glm::mat4 const & mat);
+};
+
+//! Vertices of a skinned mesh in structure-of-arrays layout
+/*!
+    Every vertex has max_influences (joint, weight) pairs, missing ones have zero weight.
+    Influence k of vertex v is stored at [k * num_vertices + v], joints index the
+    matrix array passed to the skinning functions.
+*/
+struct SkinData
+{
+    uint32_t              num_vertices;
+    uint32_t              max_influences;
+    std::vector<float>    x, y, z;   // bind positions
+    std::vector<uint32_t> joints;
+    std::vector<float>    weights;
+
+    SkinData() : num_vertices(0), max_influences(0) {}
+};
+
+/*! Gather positions and influences of a mesh for skinning
+    \param[in] joint_of  bool(influence, uint32_t & joint) gives index of the influence joint
+                         in the matrix array, false drops the influence
+*/
+template<typename Influence, typename JointOf>
+SkinData BuildSkinData(std::vector<glm::vec3> const & pos, std::vector<std::vector<Influence>> const & influences,
+                       JointOf joint_of)
+{
+    SkinData skin;
+    skin.num_vertices = static_cast<uint32_t>(pos.size());
+
+    for(auto const & vert : influences)
+        skin.max_influences = std::max(skin.max_influences, static_cast<uint32_t>(vert.size()));
+
+    skin.x.resize(pos.size());
+    skin.y.resize(pos.size());
+    skin.z.resize(pos.size());
+    for(size_t v = 0; v < pos.size(); ++v)
+    {
+        skin.x[v] = pos[v].x;
+        skin.y[v] = pos[v].y;
+        skin.z[v] = pos[v].z;
+    }
+
+    skin.joints.assign(size_t(skin.max_influences) * pos.size(), 0);
+    skin.weights.assign(size_t(skin.max_influences) * pos.size(), 0.0f);
+    for(size_t v = 0; v < pos.size() && v < influences.size(); ++v)
+    {
+        for(size_t k = 0; k < influences[v].size(); ++k)
+        {
+            uint32_t joint;
+            if(!joint_of(influences[v][k], joint))
+                continue;
+
+            skin.joints[k * pos.size() + v]  = joint;
+            skin.weights[k * pos.size() + v] = influences[v][k].w;
+        }
+    }
+
+    return skin;
+}
+
+//! Linear blend skinning of positions, out_x/y/z must hold skin.num_vertices floats
+/*! Vertices are processed four at a time with SSE when available,
+    vertices without influences are skinned to the origin.
+*/
+void SkinPositions(SkinData const & skin, SkinMatrix const * matrices, float * out_x, float * out_y, float * out_z);
+
+//! Bounding box of the skinned positions, the positions are not stored
+AABB SkinnedBounds(SkinData const & skin, SkinMatrix const * matrices);
+
+#endif   // SKINNING_H
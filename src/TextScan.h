@@ -0,0 +1,181 @@
+#ifndef TEXTSCAN_H
+#define TEXTSCAN_H
+
+// Pointer based scanning of text buffers: no allocations, no locale,
+// buffers don't have to be null terminated.
+// Numeric lists (COLLADA arrays, index lists) are parsed in bulk by ParseNumberList.
+
+#include <charconv>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+inline bool IsBlank(char c)
+{
+    return c == ' ' || c == '\t' || c == '\r';
+}
+
+inline bool IsSpace(char c)
+{
+    return IsBlank(c) || c == '\n';
+}
+
+//! Skip spaces and tabs, stops at the end of line
+inline char const * SkipBlanks(char const * p, char const * end)
+{
+    while(p < end && IsBlank(*p))
+        ++p;
+
+    return p;
+}
+
+//! Skip all whitespace including line ends
+inline char const * SkipSpaces(char const * p, char const * end)
+{
+    while(p < end && IsSpace(*p))
+        ++p;
+
+    return p;
+}
+
+//! Pointer to the '\n' which ends the line, or end
+inline char const * FindLineEnd(char const * p, char const * end)
+{
+    auto nl = static_cast<char const *>(std::memchr(p, '\n', end - p));
+    return nl != nullptr ? nl : end;
+}
+
+//! Check that [p, end) begins with the keyword followed by a blank or the end of line
+inline bool IsKeyword(char const * p, char const * end, char const * keyword)
+{
+    size_t len = std::strlen(keyword);
+    if(static_cast<size_t>(end - p) < len || std::memcmp(p, keyword, len) != 0)
+        return false;
+
+    return p + len == end || IsBlank(p[len]);
+}
+
+/*! Parse float at p (leading blanks are skipped)
+    \return false if there is no number, p is not moved then
+*/
+inline bool ParseFloat(char const *& p, char const * end, float & val)
+{
+    char const * s = SkipBlanks(p, end);
+    if(s < end && *s == '+')
+        ++s;
+
+#if defined(__cpp_lib_to_chars)
+    auto res = std::from_chars(s, end, val);
+    if(res.ec != std::errc())
+        return false;
+
+    p = res.ptr;
+#else
+    // std::from_chars for floating point is not available in the standard library
+    char   buf[64];
+    size_t len = 0;
+    while(s + len < end && len < sizeof(buf) - 1 && !IsBlank(s[len]) && s[len] != '\n')
+    {
+        buf[len] = s[len];
+        ++len;
+    }
+    buf[len] = '\0';
+
+    char * num_end;
+    val = std::strtof(buf, &num_end);
+    if(num_end == buf)
+        return false;
+
+    p = s + (num_end - buf);
+#endif
+
+    return true;
+}
+
+/*! Parse integer at p (leading blanks are skipped)
+    \return false if there is no number, p is not moved then
+*/
+inline bool ParseInt(char const *& p, char const * end, int32_t & val)
+{
+    char const * s = SkipBlanks(p, end);
+    if(s < end && *s == '+')
+        ++s;
+
+    auto res = std::from_chars(s, end, val);
+    if(res.ec != std::errc())
+        return false;
+
+    p = res.ptr;
+    return true;
+}
+
+/*! Parse unsigned integer at p (leading blanks are skipped)
+    \return false if there is no number, p is not moved then
+*/
+inline bool ParseUInt(char const *& p, char const * end, uint32_t & val)
+{
+    char const * s = SkipBlanks(p, end);
+    if(s < end && *s == '+')
+        ++s;
+
+    auto res = std::from_chars(s, end, val);
+    if(res.ec != std::errc())
+        return false;
+
+    p = res.ptr;
+    return true;
+}
+
+inline bool ParseNumber(char const *& p, char const * end, float & val)
+{
+    return ParseFloat(p, end, val);
+}
+
+inline bool ParseNumber(char const *& p, char const * end, int32_t & val)
+{
+    return ParseInt(p, end, val);
+}
+
+inline bool ParseNumber(char const *& p, char const * end, uint32_t & val)
+{
+    return ParseUInt(p, end, val);
+}
+
+/*! Parse count whitespace separated numbers into out
+    \return number of parsed values, less than count if a non number is met
+*/
+template<typename T>
+size_t ParseNumberList(char const *& p, char const * end, T * out, size_t count)
+{
+    for(size_t i = 0; i < count; ++i)
+    {
+        p = SkipSpaces(p, end);
+        if(!ParseNumber(p, end, out[i]))
+            return i;
+    }
+
+    return count;
+}
+
+/*! Append up to max_count whitespace separated numbers to out, the caller reserves the vector
+    \return number of appended values, parsing stops at the first non number
+*/
+template<typename T>
+size_t ParseNumberList(char const *& p, char const * end, std::vector<T> & out, size_t max_count = SIZE_MAX)
+{
+    size_t num = 0;
+    T      val;
+    for(; num < max_count; ++num)
+    {
+        p = SkipSpaces(p, end);
+        if(!ParseNumber(p, end, val))
+            break;
+
+        out.push_back(val);
+    }
+
+    return num;
+}
+
+#endif   // TEXTSCAN_H
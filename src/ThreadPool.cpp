@@ -0,0 +1,133 @@
+#include "ThreadPool.h"
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <memory>
+
+static uint32_t g_num_threads = 0;
+
+ThreadPool::ThreadPool(uint32_t num_threads) : m_stop(false)
+{
+    if(num_threads == 0)
+        num_threads = std::thread::hardware_concurrency();
+
+    for(uint32_t i = 1; i < num_threads; ++i)
+        m_workers.emplace_back(&ThreadPool::WorkerLoop, this);
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_cond.notify_all();
+
+    for(auto & th : m_workers)
+        th.join();
+}
+
+void ThreadPool::WorkerLoop()
+{
+    while(true)
+    {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_cond.wait(lock, [this] { return m_stop || !m_tasks.empty(); });
+
+            if(m_stop && m_tasks.empty())
+                return;
+
+            task = std::move(m_tasks.front());
+            m_tasks.pop_front();
+        }
+
+        task();
+    }
+}
+
+void ThreadPool::Submit(std::function<void()> task)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_tasks.push_back(std::move(task));
+    }
+    m_cond.notify_one();
+}
+
+void ThreadPool::ParallelFor(uint32_t count, std::function<void(uint32_t)> const & func)
+{
+    if(count == 0)
+        return;
+
+    if(m_workers.empty() || count == 1)
+    {
+        for(uint32_t i = 0; i < count; ++i)
+            func(i);
+
+        return;
+    }
+
+    // Helpers may start after the loop is over, they must not touch func then
+    struct State
+    {
+        std::atomic<uint32_t>                 next{0};
+        std::atomic<uint32_t>                 done{0};
+        uint32_t                              count;
+        std::function<void(uint32_t)> const * func;
+        std::exception_ptr                    error;
+        std::mutex                            mutex;
+        std::condition_variable               cond;
+    };
+
+    auto state   = std::make_shared<State>();
+    state->count = count;
+    state->func  = &func;
+
+    auto run = [state]() {
+        uint32_t i;
+        while((i = state->next++) < state->count)
+        {
+            try
+            {
+                (*state->func)(i);
+            }
+            catch(...)
+            {
+                std::lock_guard<std::mutex> lock(state->mutex);
+                if(!state->error)
+                    state->error = std::current_exception();
+            }
+
+            if(++state->done == state->count)
+            {
+                std::lock_guard<std::mutex> lock(state->mutex);
+                state->cond.notify_all();
+            }
+        }
+    };
+
+    uint32_t num_helpers = std::min(static_cast<uint32_t>(m_workers.size()), count - 1);
+    for(uint32_t i = 0; i < num_helpers; ++i)
+        Submit(run);
+
+    run();
+
+    std::unique_lock<std::mutex> lock(state->mutex);
+    state->cond.wait(lock, [&state] { return state->done == state->count; });
+
+    if(state->error)
+        std::rethrow_exception(state->error);
+}
+
+void ThreadPool::SetNumThreads(uint32_t num_threads)
+{
+    g_num_threads = num_threads;
+}
+
+ThreadPool & ThreadPool::Instance()
+{
+    static ThreadPool pool(g_num_threads);
+    return pool;
+}
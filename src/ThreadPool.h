@@ -0,0 +1,50 @@
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+//! Fixed size pool of worker threads
+/*!
+    ParallelFor is safe to nest: the calling thread processes items itself and
+    only waits for items that are already running on other threads.
+*/
+class ThreadPool
+{
+    std::vector<std::thread>          m_workers;
+    std::deque<std::function<void()>> m_tasks;
+    std::mutex                        m_mutex;
+    std::condition_variable           m_cond;
+    bool                              m_stop;
+
+    void WorkerLoop();
+
+public:
+    //! num_threads includes the calling thread, 0 - number of hardware threads
+    explicit ThreadPool(uint32_t num_threads);
+    ~ThreadPool();
+
+    ThreadPool(ThreadPool const &) = delete;
+    ThreadPool & operator=(ThreadPool const &) = delete;
+
+    //! Number of threads taking part in ParallelFor (workers + calling thread)
+    uint32_t NumThreads() const { return static_cast<uint32_t>(m_workers.size()) + 1; }
+
+    void Submit(std::function<void()> task);
+
+    /*! Call func(i) for every i in [0, count) using all threads of the pool
+        The first exception thrown by func is rethrown after all items are done.
+    */
+    void ParallelFor(uint32_t count, std::function<void(uint32_t)> const & func);
+
+    //! Set size of the shared pool, must be called before the first Instance()
+    static void         SetNumThreads(uint32_t num_threads);
+    static ThreadPool & Instance();
+};
+
+#endif   // THREADPOOL_H
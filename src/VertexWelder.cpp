@@ -0,0 +1,97 @@
+#include "VertexWelder.h"
+#include "utils.h"
+#include <cassert>
+#include <cmath>
+
+VertexWelder::VertexWelder(uint32_t stride) : m_stride(stride) {}
+
+void VertexWelder::Reset(uint32_t stride, uint32_t expected_vertices)
+{
+    assert(stride >= 3);
+
+    m_stride = stride;
+    m_verts.clear();
+    m_cells.Clear();
+    m_next_in_cell.clear();
+
+    if(expected_vertices > 0)
+    {
+        m_verts.reserve(static_cast<size_t>(expected_vertices) * stride);
+        m_next_in_cell.reserve(expected_vertices);
+        m_cells.Reserve(expected_vertices);
+    }
+}
+
+// Quantization is done in double precision, so values closer than epsilon
+// always land in the same or in adjacent cells
+static int64_t Quantize(float v)
+{
+    return static_cast<int64_t>(std::floor(static_cast<double>(v) / Epsilon<float>::epsilon()));
+}
+
+VertexWelder::CellKey VertexWelder::GetCell(float const * vert) const
+{
+    return CellKey{Quantize(vert[0]), Quantize(vert[1]), Quantize(vert[2])};
+}
+
+bool VertexWelder::IsSimilar(float const * vert, uint32_t index) const
+{
+    float const * other = &m_verts[static_cast<size_t>(index) * m_stride];
+    for(uint32_t i = 0; i < m_stride; ++i)
+    {
+        if(!IsNear(vert[i], other[i]))
+            return false;
+    }
+
+    return true;
+}
+
+bool VertexWelder::FindSimilar(float const * vert, uint32_t * found_ind) const
+{
+    assert(m_stride != 0);
+
+    // The earliest similar vertex wins, like in a linear search. Chains are newest first,
+    // so the minimum index is taken over all probed cells.
+    uint32_t found = npos;
+
+    // Components may differ by one grid cell, probe the neighbour position cells
+    CellKey cell = GetCell(vert);
+    for(int64_t dx = -1; dx <= 1; ++dx)
+    {
+        for(int64_t dy = -1; dy <= 1; ++dy)
+        {
+            for(int64_t dz = -1; dz <= 1; ++dz)
+            {
+                uint32_t const * head = m_cells.Find(CellKey{cell.x + dx, cell.y + dy, cell.z + dz});
+                if(head == nullptr)
+                    continue;
+
+                for(uint32_t i = *head; i != npos; i = m_next_in_cell[i])
+                {
+                    if(i < found && IsSimilar(vert, i))
+                        found = i;
+                }
+            }
+        }
+    }
+
+    if(found == npos)
+        return false;
+
+    *found_ind = found;
+    return true;
+}
+
+uint32_t VertexWelder::Add(float const * vert)
+{
+    assert(m_stride != 0);
+
+    uint32_t index = Size();
+    m_verts.insert(m_verts.end(), vert, vert + m_stride);
+
+    auto cell = m_cells.Insert(GetCell(vert), index);
+    m_next_in_cell.push_back(cell.second ? npos : *cell.first);
+    *cell.first = index;
+
+    return index;
+}
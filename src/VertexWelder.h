@@ -0,0 +1,67 @@
+#ifndef VERTEXWELDER_H
+#define VERTEXWELDER_H
+
+#include "FlatHashMap.h"
+#include <cstdint>
+#include <vector>
+
+//! Tolerance based vertex welding
+/*!
+    A vertex is a flat tuple of floats, the position comes first. Two vertices are
+    similar when every pair of components differs less than Epsilon<float>::epsilon(),
+    the same rule VecEqual applies.
+    Positions are quantized to the epsilon grid and similar vertices are found by
+    probing the 27 position cells around the vertex. Welding n vertices takes
+    expected O(n) time.
+*/
+class VertexWelder
+{
+    struct CellKey
+    {
+        int64_t x, y, z;
+
+        bool operator==(CellKey const & rhs) const { return x == rhs.x && y == rhs.y && z == rhs.z; }
+    };
+
+    struct CellKeyHash
+    {
+        size_t operator()(CellKey const & key) const
+        {
+            return HashCombine(HashCombine(static_cast<uint64_t>(key.x), static_cast<uint64_t>(key.y)),
+                               static_cast<uint64_t>(key.z));
+        }
+    };
+
+    static constexpr uint32_t npos = 0xFFFFFFFF;
+
+    uint32_t           m_stride;
+    std::vector<float> m_verts;   // m_stride floats per vertex
+
+    // The table keeps the last added vertex of a cell, older ones are chained
+    FlatHashMap<CellKey, uint32_t, CellKeyHash> m_cells;   // quantized position
+    std::vector<uint32_t>                       m_next_in_cell;
+
+    bool    IsSimilar(float const * vert, uint32_t index) const;
+    CellKey GetCell(float const * vert) const;
+
+public:
+    explicit VertexWelder(uint32_t stride = 0);
+
+    //! Drop all vertices and start welding tuples of the given size
+    void Reset(uint32_t stride, uint32_t expected_vertices = 0);
+
+    uint32_t Stride() const { return m_stride; }
+    uint32_t Size() const { return m_stride == 0 ? 0 : static_cast<uint32_t>(m_verts.size() / m_stride); }
+
+    /*! Search a previously added vertex similar to vert
+        \param[in] vert m_stride floats
+        \param[out] found_ind index of the found vertex
+        \return true if a similar vertex exists
+    */
+    bool FindSimilar(float const * vert, uint32_t * found_ind) const;
+
+    //! Add vertex, returns its index (vertices are numbered in order of addition)
+    uint32_t Add(float const * vert);
+};
+
+#endif   // VERTEXWELDER_H
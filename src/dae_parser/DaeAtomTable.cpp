@@ -0,0 +1,36 @@
+#include "DaeAtomTable.h"
+
+DaeAtom DaeAtomTable::Intern(std::string const & id)
+{
+    if(id.empty())
+        return no_atom;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    auto res = m_index.Insert(id, static_cast<DaeAtom>(m_strings.size() + 1));
+    if(res.second)
+        m_strings.push_back(id);
+
+    return *res.first;
+}
+
+DaeAtom DaeAtomTable::Find(std::string const & id) const
+{
+    if(id.empty())
+        return no_atom;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    DaeAtom const * atom = m_index.Find(id);
+    return atom != nullptr ? *atom : no_atom;
+}
+
+std::string const & DaeAtomTable::Str(DaeAtom atom) const
+{
+    static std::string const empty;
+    if(atom == no_atom)
+        return empty;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_strings[atom - 1];
+}
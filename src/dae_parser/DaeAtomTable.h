@@ -0,0 +1,49 @@
+#ifndef DAEATOMTABLE_H
+#define DAEATOMTABLE_H
+
+#include "../FlatHashMap.h"
+#include <deque>
+#include <mutex>
+#include <string>
+
+//! Interned COLLADA id, equal ids have equal atoms
+using DaeAtom = uint32_t;
+
+//! Atom of the empty id, also returned for ids which were never interned
+constexpr DaeAtom no_atom = 0;
+
+//! Table of all ids of a document
+/*!
+    Ids and references are interned once while parsing, after that every cross-reference
+    is resolved by an integer hash lookup. Interning is thread safe, libraries are
+    parsed concurrently.
+*/
+class DaeAtomTable
+{
+    mutable std::mutex                m_mutex;
+    FlatHashMap<std::string, DaeAtom> m_index;
+    std::deque<std::string>           m_strings;   // m_strings[atom - 1], references stay valid
+
+public:
+    DaeAtomTable() = default;
+
+    DaeAtomTable(DaeAtomTable const &) = delete;
+    DaeAtomTable & operator=(DaeAtomTable const &) = delete;
+
+    //! Atom of id, unseen ids get a new atom
+    DaeAtom Intern(std::string const & id);
+    DaeAtom Intern(char const * id) { return Intern(std::string(id)); }
+
+    //! Intern URI fragment reference, the leading '#' is dropped
+    DaeAtom InternRef(char const * url) { return Intern(url[0] == '#' ? url + 1 : url); }
+
+    //! Atom of an already interned id or no_atom, the table is not changed
+    DaeAtom Find(std::string const & id) const;
+
+    std::string const & Str(DaeAtom atom) const;
+};
+
+//! Hash index from atoms to positions in a library vector
+using DaeAtomIndex = FlatHashMap<DaeAtom, uint32_t>;
+
+#endif   // DAEATOMTABLE_H
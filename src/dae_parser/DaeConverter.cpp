@@ -1,4 +1,7 @@
 #include "DaeConverter.h"
+#include "../SimdMath.h"
+#include "../ThreadPool.h"
+#include "../VertexWelder.h"
 #include "../utils.h"
 #include "DaeLibraryAnimations.h"
 #include "DaeLibraryControllers.h"
@@ -61,7 +64,7 @@ glm::mat4 CreateTransformMatrix(std::vector<DaeTransformation> const & trans_sta
  *
  ******************************************************************************/
 DaeConverter::DaeConverter(DaeParser const & parser) :
-    m_parser(parser), m_frame_count(0), m_max_anim_time(0.0f)
+    m_parser(parser), m_frame_count(0), m_min_anim_time(0.0f), m_max_anim_time(0.0f)
 {}
 
 void DaeConverter::Convert()
@@ -95,6 +98,7 @@ void DaeConverter::ConvertScene(DaeVisualScene const & sc)
     if(!m_parser._anim->_animations.empty())
     {
         m_frame_count   = m_parser._anim->_max_frame_count;
+        m_min_anim_time = m_parser._anim->_min_anim_time;
         m_max_anim_time = m_parser._anim->_max_anim_time;
     }
 
@@ -108,7 +112,7 @@ void DaeConverter::ConvertScene(DaeVisualScene const & sc)
 
     for(size_t i = 0; i < sc._nodes.size(); i++)
     {
-        ProcessNode(sc._nodes[i], nullptr, rt, sc, anim_trans_accum);
+        ProcessNode(sc._nodes[i], nullptr, rt, sc, anim_trans_accum.data());
     }
 
     if(!m_joints.empty())
@@ -119,12 +123,13 @@ void DaeConverter::ConvertScene(DaeVisualScene const & sc)
 }
 
 SceneNode * DaeConverter::ProcessNode(DaeNode const & node, SceneNode * parent, glm::mat4 trans_accum,
-                                      DaeVisualScene const & sc, std::vector<glm::mat4> anim_trans_accum)
+                                      DaeVisualScene const & sc, glm::mat4 const * anim_trans_accum)
 {
-    // Note: animTransAccum is used for pure transformation nodes of Collada that are no joints or meshes
+    // Note: animTransAccum is used for pure transformation nodes of Collada that are no joints or meshes,
+    // it holds a matrix for every frame, nullptr is identity
     if(node._reference)
     {
-        DaeNode const * nd = sc.FindNode(node._name);
+        DaeNode const * nd = sc.FindNode(node._id);
         if(nd)
             return ProcessNode(*nd, parent, trans_accum, sc, anim_trans_accum);
         else
@@ -180,26 +185,46 @@ SceneNode * DaeConverter::ProcessNode(DaeNode const & node, SceneNode * parent,
         trans_accum = trans_accum * rel_mat;
     }
 
-    // Animation
-    for(uint32_t i = 0; i < m_frame_count; ++i)
+    // Animation, frames of meshes are not used
+    std::vector<glm::mat4> pure_trans_accum;
+    if(m_frame_count > 0 && (scene_node == nullptr || node._joint))
     {
-        glm::mat4 mat = GetNodeTransform(node, scene_node, i);
+        NodeTrack track = BindNodeTrack(node);
+
         if(scene_node != nullptr)
         {
-            if(scene_node->m_parent == nullptr)
-                mat = anim_trans_accum[i] * mat;
+            auto jnt = static_cast<JointNode *>(scene_node);
+            jnt->m_r_frames.resize(m_frame_count);
+
+            for(uint32_t i = 0; i < m_frame_count; ++i)
+            {
+                glm::mat4 mat = GetNodeTransform(track, rel_mat, i);
+                if(jnt->m_parent == nullptr && anim_trans_accum != nullptr)
+                    mat = anim_trans_accum[i] * mat;
 
-            scene_node->m_r_frames.push_back(mat);
-            anim_trans_accum[i] = glm::mat4(1.0f);
+                jnt->m_r_frames[i] = mat;
+            }
         }
         else
-            anim_trans_accum[i] = anim_trans_accum[i] * mat;   // Pure transformation node
+        {
+            // Pure transformation node
+            pure_trans_accum.resize(m_frame_count);
+
+            for(uint32_t i = 0; i < m_frame_count; ++i)
+            {
+                glm::mat4 mat       = GetNodeTransform(track, rel_mat, i);
+                pure_trans_accum[i] = anim_trans_accum != nullptr ? anim_trans_accum[i] * mat : mat;
+            }
+        }
     }
 
+    // Scene nodes start a new accumulation for their children
+    glm::mat4 const * child_accum = pure_trans_accum.empty() ? nullptr : pure_trans_accum.data();
+
     for(auto & chd : node._children)
     {
         SceneNode * par_node = scene_node != nullptr ? scene_node : parent;
-        SceneNode * snd      = ProcessNode(*chd, par_node, trans_accum, sc, anim_trans_accum);
+        SceneNode * snd      = ProcessNode(*chd, par_node, trans_accum, sc, child_accum);
         if(snd != nullptr && par_node != nullptr)
             par_node->m_child.push_back(snd);
     }
@@ -207,88 +232,149 @@ SceneNode * DaeConverter::ProcessNode(DaeNode const & node, SceneNode * parent,
     return scene_node;
 }
 
-glm::mat4 DaeConverter::GetNodeTransform(DaeNode const & node, SceneNode const * scene_node,
-                                         uint32_t frame) const
+NodeTrack DaeConverter::BindNodeTrack(DaeNode const & node) const
 {
-    int          tr_index = -1;
-    glm::mat4    tr       = glm::mat4(1.0);
-    DaeSampler * sampler  = m_parser._anim->FindAnimForTarget(node._id, &tr_index);
+    NodeTrack track;
+    auto      channels = m_parser._anim->FindChannelsForTarget(node._id);
 
-    if(sampler != nullptr)
+    // If no animation data is found, standard transformation is used
+    if(channels == nullptr)
+        return track;
+
+    track.m_trans_stack = node._trans_stack;
+    for(DaeChannel const * chn : *channels)
     {
-        if(sampler->_output->_floatArray.size() == m_frame_count * 16)
+        DaeSampler const * sampler = chn->_source;
+        unsigned int       stride  = sampler->_output->_paramsPerItem;
+        bool               full    = chn->_trans_values_index == -1;
+
+        if(sampler->_input->_floatArray.empty() || sampler->_output->_floatArray.size() < stride)
+            continue;
+
+        auto it = std::find_if(track.m_trans_stack.begin(), track.m_trans_stack.end(),
+                               [chn](DaeTransformation const & tr) { return tr._sid == chn->_trans_sid; });
+        if(it == track.m_trans_stack.end() && full && stride == 16)
         {
-            tr = CreateDAEMatrix(&sampler->_output->_floatArray[frame * 16]);
+            // Matrix of an unknown transformation replaces the whole node transformation
+            DaeTransformation tr;
+            tr._sid  = chn->_trans_sid;
+            tr._type = DaeTransformation::Type::MATRIX;
+            std::copy_n(sampler->_output->_floatArray.begin(), 16, tr._values);
+
+            track.m_channels.clear();
+            track.m_trans_stack.assign(1, tr);
+            it = track.m_trans_stack.begin();
         }
-        else
-        {
-            std::stringstream ss;
-            ss << "Error: Animation data not sampled"
-               << "\n";
 
-            throw std::runtime_error(ss.str());
+        if(it == track.m_trans_stack.end() || chn->_trans_values_index >= 16 || stride > 16)
+        {
+            std::cout << "Warning: Animation target '" << m_parser._atoms->Str(node._id) << "/"
+                      << chn->_trans_sid << "' not supported" << std::endl;
+            continue;
         }
+
+        auto trans = static_cast<uint32_t>(it - track.m_trans_stack.begin());
+        track.m_channels.push_back(NodeTrack::Channel{sampler, trans, chn->_trans_values_index});
     }
-    else
+
+    if(track.m_channels.empty())
+        return track;
+
+    // Matrices sampled for every frame are used directly
+    NodeTrack::Channel const & chn = track.m_channels[0];
+    if(track.m_channels.size() == 1 && track.m_trans_stack.size() == 1 && chn.m_values_index == -1
+       && track.m_trans_stack[0]._type == DaeTransformation::Type::MATRIX
+       && chn.m_sampler->_output->_floatArray.size() == m_frame_count * 16)
     {
-        // If no animation data is found, use standard transformation
-        if(scene_node != nullptr)
-        {
-            tr = scene_node->m_rel_transf;
-        }
-        else
-            tr = CreateTransformMatrix(node._trans_stack);
+        track.m_type     = NodeTrack::Type::MATRIX;
+        track.m_matrices = chn.m_sampler->_output->_floatArray.data();
     }
+    else
+        track.m_type = NodeTrack::Type::SAMPLED;
 
-    return tr;
+    return track;
 }
 
-void CalcJointFrame(JointNode * nd, JointNode * parent)
+float DaeConverter::GetFrameTime(uint32_t frame) const
 {
-    for(uint32_t i = 0; i < nd->m_r_frames.size(); i++)
+    if(m_frame_count < 2)
+        return m_min_anim_time;
+
+    return m_min_anim_time + (m_max_anim_time - m_min_anim_time) * frame / (m_frame_count - 1);
+}
+
+glm::mat4 DaeConverter::GetNodeTransform(NodeTrack & track, glm::mat4 const & rel_mat, uint32_t frame) const
+{
+    if(track.m_type == NodeTrack::Type::MATRIX)
+        return CreateDAEMatrix(track.m_matrices + frame * 16);
+
+    if(track.m_type == NodeTrack::Type::SAMPLED)
     {
-        glm::mat4 par_tr = glm::mat4(1.0);
-        if(parent != nullptr)
-            par_tr = parent->m_a_frames[i];
-        nd->m_a_frames.push_back(par_tr * nd->m_r_frames[i]);
+        float time = GetFrameTime(frame);
+        float values[16];
+
+        for(auto & chn : track.m_channels)
+        {
+            DaeTransformation & tr = track.m_trans_stack[chn.m_trans];
+
+            chn.m_sampler->Evaluate(time, values);
+            if(chn.m_values_index == -1)
+                std::copy_n(values, chn.m_sampler->_output->_paramsPerItem, tr._values);
+            else
+                tr._values[chn.m_values_index] = values[0];
+        }
+
+        return CreateTransformMatrix(track.m_trans_stack);
     }
 
-    for(uint32_t i = 0; i < nd->m_child.size(); i++)
+    return rel_mat;
+}
+
+void DaeConverter::CollectRelPoses()
+{
+    for(auto & msh : m_meshes)
     {
-        auto chd = dynamic_cast<JointNode *>(nd->m_child[i]);
-        if(chd == nullptr)
+        if(msh->m_parent != nullptr && msh->m_parent->m_joint)
         {
             std::stringstream ss;
             ss << "Error: Armature has mesh node" << std::endl;
             throw std::runtime_error(ss.str());
         }
-        CalcJointFrame(chd, nd);
     }
-}
 
-void DaeConverter::CalcAbsTransfMatrices()
-{
-    auto it =
-        std::find_if(m_joints.begin(), m_joints.end(),
-                     [](std::unique_ptr<JointNode> const & nd) -> bool { return nd->m_parent == nullptr; });
-    if(it != m_joints.end())
+    // Absolute poses are derived on export, only for the tracks requested there
+    size_t num_joints = m_joints.size();
+    m_rel_poses.resize(m_frame_count * num_joints);
+
+    for(size_t j = 0; j < num_joints; ++j)
     {
-        JointNode * root_joint = (*it).get();
-        CalcJointFrame(root_joint, nullptr);
+        for(uint32_t i = 0; i < m_frame_count; ++i)
+            m_rel_poses[i * num_joints + j] = m_joints[j]->m_r_frames[i];
+
+        std::vector<glm::mat4>().swap(m_joints[j]->m_r_frames);
     }
 }
 
 void DaeConverter::ProcessJoints()
 {
-    unsigned int i = 1;
-    for(auto & jnt : m_joints)
+    // Joints are collected in depth-first order, parents always precede their children
+    m_joint_parent.resize(m_joints.size());
+    for(uint32_t i = 0; i < m_joints.size(); ++i)
     {
-        jnt->m_index = i;
-        i++;
+        JointNode * jnt = m_joints[i].get();
+        jnt->m_index    = i + 1;
+
+        if(jnt->m_dae_node->_sid != no_atom)
+            m_joint_index.Insert(jnt->m_dae_node->_sid, jnt);
+
+        SceneNode const * par = jnt->m_parent;
+        m_joint_parent[i]     = par != nullptr && par->m_joint
+                                    ? static_cast<int32_t>(static_cast<JointNode const *>(par)->m_index - 1)
+                                    : -1;
     }
 
     if(m_frame_count > 0)
-        CalcAbsTransfMatrices();
+        CollectRelPoses();
 }
 
 VertexData::Semantic ConvertSemantic(DaeGeometry::Semantic sem)
@@ -341,49 +427,31 @@ VertexData::Semantic ConvertSemantic(DaeGeometry::Semantic sem)
     return s;
 }
 
-unsigned int DaeConverter::FindJointIndex(std::string const & name) const
-{
-    unsigned int indx = 0;
-
-    auto it = std::find_if(m_joints.begin(), m_joints.end(),
-                           [&name](auto & nd) -> bool { return nd->m_dae_node->_sid == name; });
-    if(it != m_joints.end())
-    {
-        indx = (*it)->m_index;
-    }
-
-    return indx;
-}
-
 void DaeConverter::ProcessMeshes()
 {
     for(auto & msh : m_meshes)
     {
         glm::mat4 trans = msh->m_abs_transf;
 
-        MeshNode *  cur_mesh = msh.get();
-        DaeSkin *   skn      = nullptr;
-        std::string geo_src;
+        MeshNode *      cur_mesh = msh.get();
+        DaeSkin const * skn      = nullptr;
+        DaeAtom         geo_src  = no_atom;
 
         for(size_t ins = 0; ins < cur_mesh->m_dae_node->_instances.size(); ins++)
         {
             if(!m_parser._controllers->_skinControllers.empty())
             {
-                std::string skin_id = cur_mesh->m_dae_node->_instances[ins]._url;
-                auto        it =
-                    std::find_if(m_parser._controllers->_skinControllers.begin(),
-                                 m_parser._controllers->_skinControllers.end(),
-                                 [&skin_id](DaeSkin const & skn) -> bool { return skn._id == skin_id; });
+                DaeAtom skin_id = cur_mesh->m_dae_node->_instances[ins]._url;
 
-                if(it != m_parser._controllers->_skinControllers.end())
+                skn = m_parser._controllers->FindSkin(skin_id);
+                if(skn != nullptr)
                 {
-                    skn     = &(*it);
                     geo_src = skn->_owner_id;
                 }
                 else
                 {
                     std::stringstream ss;
-                    ss << "ERROR! Controller node not found. Skin id: " << skin_id << "\n";
+                    ss << "ERROR! Controller node not found. Skin id: " << m_parser._atoms->Str(skin_id) << "\n";
 
                     throw std::runtime_error(ss.str());
                 }
@@ -399,7 +467,7 @@ void DaeConverter::ProcessMeshes()
                 if(skn->_joint_array == nullptr || skn->_bind_mat_array == nullptr
                    || skn->_weight_array == nullptr)
                 {
-                    std::cout << "Skin controller '" << skn->_id
+                    std::cout << "Skin controller '" << m_parser._atoms->Str(skn->_id)
                               << "' is missing information and is ignored\n";
                     skn = nullptr;
                 }
@@ -411,7 +479,7 @@ void DaeConverter::ProcessMeshes()
             if(!geometry)
             {
                 std::stringstream ss;
-                ss << "ERROR! Geometry data not found. Geometry name: " << geo_src << "\n";
+                ss << "ERROR! Geometry data not found. Geometry name: " << m_parser._atoms->Str(geo_src) << "\n";
 
                 throw std::runtime_error(ss.str());
             }
@@ -421,22 +489,13 @@ void DaeConverter::ProcessMeshes()
                 // Build lookup table
                 for(unsigned int j = 0; j < skn->_joint_array->_stringArray.size(); ++j)
                 {
-                    std::string sid = skn->_joint_array->_stringArray[j];
+                    std::string const & sid = skn->_joint_array->_stringArray[j];
 
-                    joint_lookup.push_back(nullptr);
+                    // Names of joints which are not in the scene were never interned
+                    JointNode * const * jnt = m_joint_index.Find(m_parser._atoms->Find(sid));
+                    joint_lookup.push_back(jnt != nullptr ? *jnt : nullptr);
 
-                    bool found = false;
-                    for(auto & jnt : m_joints)
-                    {
-                        if(jnt->m_dae_node->_sid == sid)
-                        {
-                            joint_lookup[j] = jnt.get();
-                            found           = true;
-                            break;
-                        }
-                    }
-
-                    if(!found)
+                    if(jnt == nullptr)
                     {
                         std::cout << "Warning: joint '" << sid << "' used in skin controller not found\n";
                     }
@@ -490,8 +549,8 @@ void DaeConverter::ProcessMeshes()
                             {
                                 VertexData::WeightsVec::Weight tw{0, 1.0f};
 
-                                tw.m_joint_index =
-                                    FindJointIndex(skn->_joint_array->_stringArray[skn_w._joint]);
+                                JointNode const * jnt = joint_lookup[skn_w._joint];
+                                tw.m_joint_index      = jnt != nullptr ? jnt->m_index : 0;
                                 tw.m_w = skn->_weight_array->_floatArray[skn_w._weight];
 
                                 vert_weight_vect.m_weights.push_back(tw);
@@ -551,10 +610,11 @@ void DaeConverter::ProcessMeshes()
                 auto & inp = geometry->_tri_groups[0]._meshes[0]._attributes;
                 for(auto const & poly : mesh._meshes)
                 {
-                    assert(poly._triangles[0].size() == inp.size());
+                    assert(poly._triangles.Stride() == inp.size());
 
                     TriGroup      tg;
-                    DaeMaterial * mat = m_parser._material->FindMaterial(poly._material_name);
+                    DaeMaterial * mat =
+                        m_parser._material->FindMaterial(m_parser._atoms->Find(poly._material_name));
                     if(mat != nullptr)
                     {
                         tg.m_mat_id = mat->name;
@@ -568,17 +628,7 @@ void DaeConverter::ProcessMeshes()
                     }
 
                     // copy index
-                    for(auto const & tri : poly._triangles)
-                    {
-                        TriGroup::VertexAttribut index;
-
-                        for(unsigned int i = 0; i < tri.size(); ++i)
-                        {
-                            index.push_back(tri[i]);
-                        }
-
-                        tg.m_indices.push_back(std::move(index));
-                    }
+                    tg.m_indices = poly._triangles;
                     cur_mesh->m_polylists.push_back(std::move(tg));
                 }
             }
@@ -651,35 +701,27 @@ void PushVertexData(InternalData::SubMesh & msh, CurrVertexData const & vd)
         msh.tex_coords[i].push_back(vd.tex_coords[i]);
 }
 
-bool FindSimilarVertex(CurrVertexData const & vd, InternalData::SubMesh const & msh, unsigned int * found_ind)
+// Flat attribute tuple for the welder, position first
+void PackVertexData(CurrVertexData const & vd, std::vector<float> & packed)
 {
-    for(unsigned int i = 0; i < msh.pos.size(); i++)
-    {
-        bool is_equal = false;
-
-        is_equal = VecEqual(vd.pos, msh.pos[i]);
-        if(vd.is_normal)
-            is_equal = is_equal && VecEqual(vd.normal, msh.normal[i]);
-        if(vd.is_tangent)
-            is_equal = is_equal && VecEqual(vd.tangent, msh.tangent[i]);
-        if(vd.is_bitangent)
-            is_equal = is_equal && VecEqual(vd.bitangent, msh.bitangent[i]);
-        if(vd.is_color)
-            is_equal = is_equal && VecEqual(vd.color, msh.color[i]);
-
-        for(unsigned int j = 0; j < vd.tex_coords.size(); j++)
-        {
-            is_equal = is_equal && VecEqual(vd.tex_coords[j], msh.tex_coords[j][i]);
-        }
+    auto push = [&packed](auto const & v) {
+        for(int i = 0; i < v.length(); ++i)
+            packed.push_back(v[i]);
+    };
 
-        if(is_equal)
-        {
-            *found_ind = i;
-            return true;
-        }
-    }
+    packed.clear();
+    push(vd.pos);
+    if(vd.is_normal)
+        push(vd.normal);
+    if(vd.is_tangent)
+        push(vd.tangent);
+    if(vd.is_bitangent)
+        push(vd.bitangent);
+    if(vd.is_color)
+        push(vd.color);
 
-    return false;
+    for(auto const & tex : vd.tex_coords)
+        push(tex);
 }
 
 InternalData::WeightsVec GetWeightsForVertex(VertexData::WeightsVec const & wvec)
@@ -713,7 +755,10 @@ void DaeConverter::ExportToInternal(InternalData & rep, CmdLineOptions const & c
             InternalData::SubMesh sub_poly;
             sub_poly.material = poly.m_mat_id;
 
-            for(auto & indx : poly.m_indices)
+            VertexWelder       welder;
+            std::vector<float> packed;
+
+            for(auto const & indx : poly.m_indices)
             {
                 CurrVertexData vd;
                 bool           found;
@@ -768,7 +813,12 @@ void DaeConverter::ExportToInternal(InternalData & rep, CmdLineOptions const & c
                     }
                 }
 
-                found = FindSimilarVertex(vd, sub_poly, &founded_index);
+                PackVertexData(vd, packed);
+                if(welder.Stride() == 0)
+                    welder.Reset(static_cast<uint32_t>(packed.size()),
+                                 static_cast<uint32_t>(poly.m_indices.Size()));
+
+                found = welder.FindSimilar(packed.data(), &founded_index);
                 if(found)
                 {
                     sub_poly.indexes.push_back(founded_index);
@@ -776,6 +826,7 @@ void DaeConverter::ExportToInternal(InternalData & rep, CmdLineOptions const & c
                 else
                 {
                     PushVertexData(sub_poly, vd);
+                    welder.Add(packed.data());
                     if(!mesh->m_vertices.m_wght.empty())   // for skinned mesh
                         sub_poly.weights.push_back(GetWeightsForVertex(mesh->m_vertices.m_wght[pos_index]));
 
@@ -790,22 +841,30 @@ void DaeConverter::ExportToInternal(InternalData & rep, CmdLineOptions const & c
 
     if(!m_joints.empty())
     {
-        rep.num_frames        = m_frame_count;
-        rep.frame_rate        = m_frame_count / m_max_anim_time;
+        bool need_rel = cmd.NeedRelativeTracks();
+        bool need_abs = cmd.NeedAbsoluteTracks();
+
+        // Frames are dropped when no animation track is consumed, they span [m_min_anim_time, m_max_anim_time]
+        // with both ends included (see GetFrameTime)
+        float anim_length     = m_max_anim_time - m_min_anim_time;
+        rep.num_frames        = need_rel || need_abs ? m_frame_count : 0;
+        rep.frame_rate        = rep.num_frames > 1 && anim_length > 0.0f ? (m_frame_count - 1) / anim_length : 0.0f;
+        rep.duration          = rep.num_frames > 0 ? anim_length : 0.0f;
         uint32_t parent_check = 0;
 
-        for(auto const & joint : m_joints)
+        size_t num_joints = m_joints.size();
+        for(size_t j = 0; j < num_joints; ++j)
         {
+            JointNode const *       joint = m_joints[j].get();
             InternalData::JointNode ex_joint;
 
             ex_joint.index        = joint->m_index;
             ex_joint.name         = joint->m_dae_node->_name;
             ex_joint.inverse_bind = joint->m_inv_bind_mat;
 
-            if(joint->m_parent != nullptr)
+            if(m_joint_parent[j] >= 0)
             {
-                JointNode const * parent = dynamic_cast<JointNode const *>(joint->m_parent);
-                ex_joint.parent          = parent->m_index;
+                ex_joint.parent = m_joints[m_joint_parent[j]]->m_index;
             }
             else
             {
@@ -822,38 +881,79 @@ void DaeConverter::ExportToInternal(InternalData & rep, CmdLineOptions const & c
                 }
             }
 
-            if(m_frame_count > 0)
+            rep.joints.push_back(std::move(ex_joint));
+        }
+
+        if(rep.num_frames > 0)
+        {
+            std::vector<std::vector<glm::quat>> r_rot(need_rel ? num_joints : 0), a_rot(need_abs ? num_joints : 0);
+            std::vector<std::vector<glm::vec3>> r_trans(r_rot.size()), a_trans(a_rot.size());
+            for(size_t j = 0; j < r_rot.size(); ++j)
             {
-                for(uint16_t i = 0; i < m_frame_count; i++)
-                {
-                    // relative skinning matrices
-                    glm::mat4 rel = joint->m_r_frames[i];
-                    glm::quat rot = glm::quat_cast(rel);
-                    rot           = glm::normalize(rot);
-                    ex_joint.r_rot.push_back(rot);
-
-                    glm::vec4 transf = glm::column(rel, 3);
-                    ex_joint.r_trans.push_back(glm::vec3(transf));
-
-                    // absolute matrices
-                    glm::mat4 abs = joint->m_a_frames[i] * joint->m_inv_bind_mat;
-                    rot           = glm::quat_cast(abs);
-                    rot           = glm::normalize(rot);
-                    ex_joint.a_rot.push_back(rot);
-
-                    transf = glm::column(abs, 3);
-                    ex_joint.a_trans.push_back(glm::vec3(transf));
-                }
+                r_rot[j].resize(m_frame_count);
+                r_trans[j].resize(m_frame_count);
+            }
+            for(size_t j = 0; j < a_rot.size(); ++j)
+            {
+                a_rot[j].resize(m_frame_count);
+                a_trans[j].resize(m_frame_count);
             }
 
-            rep.joints.push_back(std::move(ex_joint));
+            // Frames are independent, absolute poses live only in a per task buffer
+            constexpr uint32_t frames_per_task = 64;
+            uint32_t           num_tasks       = (m_frame_count + frames_per_task - 1) / frames_per_task;
 
-            // std::cout << glm::to_string(glm::transpose(joint->_inv_bind)) << std::endl;
-            // std::cout << glm::to_string(glm::transpose(joint->_transf)) << std::endl << std::endl;
+            ThreadPool::Instance().ParallelFor(num_tasks, [&](uint32_t task) {
+                std::vector<glm::mat4> abs_poses(need_abs ? num_joints : 0);
+
+                uint32_t end = std::min(m_frame_count, (task + 1) * frames_per_task);
+                for(uint32_t i = task * frames_per_task; i < end; ++i)
+                {
+                    glm::mat4 const * rel = &m_rel_poses[i * num_joints];
+                    for(size_t j = 0; j < num_joints; ++j)
+                    {
+                        // relative skinning matrices
+                        if(need_rel)
+                        {
+                            r_rot[j][i]   = glm::normalize(glm::quat_cast(rel[j]));
+                            r_trans[j][i] = glm::vec3(glm::column(rel[j], 3));
+                        }
+
+                        // absolute matrices, parents precede their children
+                        if(need_abs)
+                        {
+                            int32_t par = m_joint_parent[j];
+                            if(par < 0)
+                                abs_poses[j] = rel[j];
+                            else
+                                MulMat4(abs_poses[par], rel[j], abs_poses[j]);
+
+                            glm::mat4 abs;
+                            MulMat4(abs_poses[j], m_joints[j]->m_inv_bind_mat, abs);
+                            a_rot[j][i]   = glm::normalize(glm::quat_cast(abs));
+                            a_trans[j][i] = glm::vec3(glm::column(abs, 3));
+                        }
+                    }
+                }
+            });
+
+            // Static channels are stored as one value
+            for(size_t j = 0; j < r_rot.size(); ++j)
+            {
+                rep.joints[j].r_rot.Assign(std::move(r_rot[j]));
+                rep.joints[j].r_trans.Assign(std::move(r_trans[j]));
+            }
+            for(size_t j = 0; j < a_rot.size(); ++j)
+            {
+                rep.joints[j].a_rot.Assign(std::move(a_rot[j]));
+                rep.joints[j].a_trans.Assign(std::move(a_trans[j]));
+            }
         }
     }
 
-    rep.CalculateBBoxes();
+    if(cmd.anim_fps > 0.0f)
+        rep.ResampleAnimation(cmd.anim_fps);
+    rep.CalculateBBoxes(cmd.exact_bboxes);
 
     if(!m_parser._material->materials.empty())
     {
@@ -2,13 +2,15 @@
 #define DAECONVERTER_H
 
 #include "../Converter.h"
+#include "../IndexStream.h"
+#include "DaeAtomTable.h"
+#include "DaeLibraryVisualScenes.h"
 #include "DaeParser.h"
 #include <glm/glm.hpp>
 #include <vector>
 
-class DaeNode;
 class DaeSkin;
-class DaeVisualScene;
+struct DaeSampler;
 
 struct VertexData
 {
@@ -52,10 +54,34 @@ struct VertexData
 
 struct TriGroup
 {
-    using VertexAttribut = std::vector<unsigned int>;
+    IndexStream m_indices;   // m_indices.Stride() == _sources_vec3.size() + _sources_vec2.size()
+    std::string m_mat_id;
+};
+
+//! Animation track of a scene node, resolved once before frames are evaluated
+struct NodeTrack
+{
+    enum class Type
+    {
+        STATIC,    // not animated, relative transformation in every frame
+        MATRIX,    // sampled matrix for every frame
+        SAMPLED,   // channels are evaluated at the frame time
+    };
 
-    std::vector<VertexAttribut> m_indices;   // _indices.size() == _sources_vec3.size() + _sources_vec2.size()
-    std::string                 m_mat_id;
+    //! Sampler animating values of one transformation of the node
+    struct Channel
+    {
+        DaeSampler const * m_sampler;
+        uint32_t           m_trans;          // index in m_trans_stack
+        int                m_values_index;   // index in transformation values (-1 for all values)
+    };
+
+    Type                           m_type;
+    float const *                  m_matrices;      // m_frame_count * 16 floats for MATRIX type
+    std::vector<Channel>           m_channels;      // for SAMPLED type
+    std::vector<DaeTransformation> m_trans_stack;   // for SAMPLED type, animated values are overwritten
+
+    NodeTrack() : m_type(Type::STATIC), m_matrices(nullptr) {}
 };
 
 struct SceneNode
@@ -65,9 +91,6 @@ struct SceneNode
     glm::mat4 m_abs_transf;   // absolute transform
     glm::mat4 m_rel_transf;   // relative transform
 
-    std::vector<glm::mat4> m_r_frames;   // relative transformation for every frame
-    std::vector<glm::mat4> m_a_frames;   // absolute transformation for every frame
-
     SceneNode *              m_parent;
     std::vector<SceneNode *> m_child;
 
@@ -90,8 +113,9 @@ struct MeshNode : public SceneNode
 
 struct JointNode : public SceneNode
 {
-    unsigned int m_index;
-    glm::mat4    m_inv_bind_mat;   // inverse bind matrix
+    unsigned int           m_index;
+    glm::mat4              m_inv_bind_mat;   // inverse bind matrix
+    std::vector<glm::mat4> m_r_frames;       // relative transformation for every frame, until ProcessJoints
 
     JointNode() : m_index(0)
     {
@@ -104,18 +128,25 @@ class DaeConverter : public Converter
 {
     DaeParser const & m_parser;
     uint32_t          m_frame_count;
+    float             m_min_anim_time;
     float             m_max_anim_time;
 
     std::vector<std::unique_ptr<MeshNode>>  m_meshes;
     std::vector<std::unique_ptr<JointNode>> m_joints;
+    FlatHashMap<DaeAtom, JointNode *>       m_joint_index;   // joint sid -> first joint with it
+
+    // Joint poses, joints are in m_joints order (topological, parents before children)
+    std::vector<int32_t>   m_joint_parent;   // index of the parent joint, -1 for root joints
+    std::vector<glm::mat4> m_rel_poses;      // relative, frame-major: [frame * m_joints.size() + joint]
 
 protected:
     void         ConvertScene(DaeVisualScene const & sc);
     SceneNode *  ProcessNode(DaeNode const & node, SceneNode * parent, glm::mat4 trans_accum,
-                             DaeVisualScene const & sc, std::vector<glm::mat4> anim_trans_accum);
-    glm::mat4    GetNodeTransform(DaeNode const & node, SceneNode const * scene_node, uint32_t frame) const;
-    void         CalcAbsTransfMatrices();
-    unsigned int FindJointIndex(std::string const & name) const;
+                             DaeVisualScene const & sc, glm::mat4 const * anim_trans_accum);
+    NodeTrack    BindNodeTrack(DaeNode const & node) const;
+    glm::mat4    GetNodeTransform(NodeTrack & track, glm::mat4 const & rel_mat, uint32_t frame) const;
+    float        GetFrameTime(uint32_t frame) const;
+    void         CollectRelPoses();
 
     void ProcessMeshes();
     void ProcessJoints();
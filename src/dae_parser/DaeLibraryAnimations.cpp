@@ -1,87 +1,220 @@
 #include "DaeLibraryAnimations.h"
 #include "DaeParser.h"
+#include <algorithm>
+#include <cmath>
 #include <cstring>
 #include <iostream>
+#include <limits>
 
 /*******************************************************************************
- * DaeAnimation
+ * DaeSampler
  *******************************************************************************/
-DaeSource * DaeAnimation::FindSource(std::string const & id) const
+// Cubic Bezier curve coordinate at parameter s
+static float Bezier(float p0, float c0, float c1, float p1, float s)
 {
-    if(id.empty())
-        return nullptr;
+    float r = 1.0f - s;
+    return r * r * r * p0 + 3.0f * r * r * s * c0 + 3.0f * r * s * s * c1 + s * s * s * p1;
+}
+
+// Curve parameter of coordinate x, the coordinate has to be monotonic on [0, 1] (p0 < p1)
+static float SolveBezier(float p0, float c0, float c1, float p1, float x)
+{
+    float lo = 0.0f, hi = 1.0f;
+    float s  = (x - p0) / (p1 - p0);
 
-    for(auto & src : _sources)
+    // Newton iterations, bisection when a step leaves the bracket
+    for(int i = 0; i < 16; ++i)
     {
-        if(src._id == id)
-            return const_cast<DaeSource *>(&src);
+        float bx = Bezier(p0, c0, c1, p1, s) - x;
+        if(std::abs(bx) <= (p1 - p0) * 1e-6f)
+            break;
+
+        if(bx < 0.0f)
+            lo = s;
+        else
+            hi = s;
+
+        float r  = 1.0f - s;
+        float dx = 3.0f * (r * r * (c0 - p0) + 2.0f * r * s * (c1 - c0) + s * s * (p1 - c1));
+        float ns = dx != 0.0f ? s - bx / dx : lo;
+        s        = ns > lo && ns < hi ? ns : 0.5f * (lo + hi);
     }
 
-    return nullptr;
+    return s;
 }
 
-DaeSampler * DaeAnimation::FindAnimForTarget(std::string const & nodeId, int * transValuesIndex) const
+DaeSampler::Interpolation DaeSampler::GetInterpolationType(std::string const & str)
 {
-    if(nodeId.empty())
-        return nullptr;
+    if(str == "STEP")
+        return Interpolation::STEP;
+    else if(str == "BEZIER")
+        return Interpolation::BEZIER;
+    else if(str == "HERMITE")
+        return Interpolation::HERMITE;
 
-    for(auto & chn : _channels)
+    // CARDINAL and BSPLINE are not supported
+    return Interpolation::LINEAR;
+}
+
+void DaeSampler::Evaluate(float time, float * out) const
+{
+    std::vector<float> const & times  = _input->_floatArray;
+    std::vector<float> const & values = _output->_floatArray;
+    unsigned int               stride = _output->_paramsPerItem;
+    size_t                     keys   = std::min(times.size(), values.size() / stride);
+
+    if(keys == 0)
+        return;
+
+    if(keys == 1 || time <= times[0])
     {
-        if(chn._node_id == nodeId)
-        {
-            if(transValuesIndex != nullptr)
-                *transValuesIndex = chn._trans_values_index;
-            return chn._source;
-        }
+        std::copy_n(values.begin(), stride, out);
+        return;
+    }
+    if(time >= times[keys - 1])
+    {
+        std::copy_n(values.begin() + (keys - 1) * stride, stride, out);
+        return;
     }
 
-    // Parse children
-    for(auto & chd : _children)
+    // Key k starts the segment of time, times[k] <= time < times[k + 1]
+    size_t        k  = std::upper_bound(times.begin(), times.begin() + keys, time) - times.begin() - 1;
+    float         t0 = times[k];
+    float         t1 = times[k + 1];
+    float const * v0 = &values[k * stride];
+    float const * v1 = &values[(k + 1) * stride];
+
+    // Tangents are (time, value) pairs per component or values only,
+    // for values only the control times are placed at thirds of the segment
+    Interpolation type    = k < _interpolation.size() ? _interpolation[k] : Interpolation::LINEAR;
+    unsigned int  tan_dim = 1;
+    if(type == Interpolation::BEZIER || type == Interpolation::HERMITE)
     {
-        DaeSampler * sampler = chd.FindAnimForTarget(nodeId, transValuesIndex);
-        if(sampler != nullptr)
-            return sampler;
+        if(_in_tangent != nullptr && _out_tangent != nullptr)
+            tan_dim = _out_tangent->_paramsPerItem == stride * 2 ? 2 : 1;
+
+        if(_in_tangent == nullptr || _out_tangent == nullptr
+           || _out_tangent->_floatArray.size() < (k + 1) * stride * tan_dim
+           || _in_tangent->_floatArray.size() < (k + 2) * stride * tan_dim)
+            type = Interpolation::LINEAR;
     }
 
-    return nullptr;
+    switch(type)
+    {
+        case Interpolation::STEP:
+            {
+                std::copy_n(v0, stride, out);
+                break;
+            }
+        case Interpolation::LINEAR:
+            {
+                float u = (time - t0) / (t1 - t0);
+                for(unsigned int c = 0; c < stride; ++c)
+                    out[c] = v0[c] + (v1[c] - v0[c]) * u;
+                break;
+            }
+        case Interpolation::BEZIER:
+        case Interpolation::HERMITE:
+            {
+                float const * ot = &_out_tangent->_floatArray[k * stride * tan_dim];
+                float const * it = &_in_tangent->_floatArray[(k + 1) * stride * tan_dim];
+
+                for(unsigned int c = 0; c < stride; ++c)
+                {
+                    float c0t = t0 + (t1 - t0) / 3.0f;
+                    float c1t = t1 - (t1 - t0) / 3.0f;
+                    float c0v, c1v;
+
+                    if(tan_dim == 2)
+                    {
+                        c0t = std::clamp(ot[c * 2], t0, t1);
+                        c1t = std::clamp(it[c * 2], t0, t1);
+                        c0v = ot[c * 2 + 1];
+                        c1v = it[c * 2 + 1];
+                    }
+                    else
+                    {
+                        c0v = ot[c];
+                        c1v = it[c];
+                    }
+
+                    // Hermite tangents are slopes over the segment
+                    if(type == Interpolation::HERMITE)
+                    {
+                        c0t = t0 + (t1 - t0) / 3.0f;
+                        c1t = t1 - (t1 - t0) / 3.0f;
+                        c0v = v0[c] + c0v / 3.0f;
+                        c1v = v1[c] - c1v / 3.0f;
+                    }
+
+                    float s = SolveBezier(t0, c0t, c1t, t1, time);
+                    out[c]  = Bezier(v0[c], c0v, c1v, v1[c], s);
+                }
+                break;
+            }
+    }
+}
+
+/*******************************************************************************
+ * DaeAnimation
+ *******************************************************************************/
+DaeSource * DaeAnimation::FindSource(DaeAtom id) const
+{
+    if(id == no_atom)
+        return nullptr;
+
+    uint32_t const * ind = _source_index.Find(id);
+
+    return ind != nullptr ? const_cast<DaeSource *>(&_sources[*ind]) : nullptr;
 }
 
-void DaeAnimation::Parse(pugi::xml_node const & animNode, unsigned int & maxFrameCount, float & maxAnimTime)
+void DaeAnimation::Parse(pugi::xml_node const & animNode, DaeAtomTable & atoms, unsigned int & maxFrameCount,
+                         float & minAnimTime, float & maxAnimTime)
 {
-    _id = animNode.attribute("id").value();
+    _id = atoms.Intern(animNode.attribute("id").value());
 
     // Sources
     for(pugi::xml_node node1 = animNode.child("source"); node1; node1 = node1.next_sibling("source"))
     {
         _sources.emplace_back();
-        _sources.back().Parse(node1);
+        _sources.back().Parse(node1, atoms);
     }
 
+    _source_index.Reserve(_sources.size());
+    for(uint32_t i = 0; i < _sources.size(); ++i)
+        _source_index.Insert(_sources[i]._id, i);
+
     // Samplers
     for(pugi::xml_node node1 = animNode.child("sampler"); node1; node1 = node1.next_sibling("sampler"))
     {
         _samplers.emplace_back();
         DaeSampler & sampler = _samplers.back();
 
-        sampler._id = node1.attribute("id").value();
+        sampler._id = atoms.Intern(node1.attribute("id").value());
 
         for(pugi::xml_node node2 = node1.child("input"); node2; node2 = node2.next_sibling("input"))
         {
             if(strcmp(node2.attribute("semantic").value(), "INPUT") == 0)
-            {
-                std::string id = node2.attribute("source").value();
-                RemoveGate(id);
-                sampler._input = FindSource(id);
-            }
+                sampler._input = FindSource(atoms.InternRef(node2.attribute("source").value()));
             else if(strcmp(node2.attribute("semantic").value(), "OUTPUT") == 0)
+                sampler._output = FindSource(atoms.InternRef(node2.attribute("source").value()));
+            else if(strcmp(node2.attribute("semantic").value(), "IN_TANGENT") == 0)
+                sampler._in_tangent = FindSource(atoms.InternRef(node2.attribute("source").value()));
+            else if(strcmp(node2.attribute("semantic").value(), "OUT_TANGENT") == 0)
+                sampler._out_tangent = FindSource(atoms.InternRef(node2.attribute("source").value()));
+            else if(strcmp(node2.attribute("semantic").value(), "INTERPOLATION") == 0)
             {
-                std::string id = node2.attribute("source").value();
-                RemoveGate(id);
-                sampler._output = FindSource(id);
+                DaeSource const * src = FindSource(atoms.InternRef(node2.attribute("source").value()));
+                if(src != nullptr)
+                {
+                    sampler._interpolation.reserve(src->_stringArray.size());
+                    for(auto & name : src->_stringArray)
+                        sampler._interpolation.push_back(DaeSampler::GetInterpolationType(name));
+                }
             }
         }
 
-        if(sampler._input == nullptr || sampler._output == nullptr)
+        if(sampler._input == nullptr || sampler._output == nullptr || sampler._output->_paramsPerItem == 0)
             _samplers.pop_back();
         else
         {
@@ -89,10 +222,18 @@ void DaeAnimation::Parse(pugi::xml_node const & animNode, unsigned int & maxFram
             maxFrameCount           = std::max(maxFrameCount, frameCount);
 
             for(unsigned int i = 0; i < frameCount; ++i)
+            {
+                minAnimTime = std::min(minAnimTime, sampler._input->_floatArray[i]);
                 maxAnimTime = std::max(maxAnimTime, sampler._input->_floatArray[i]);
+            }
         }
     }
 
+    DaeAtomIndex sampler_index;
+    sampler_index.Reserve(_samplers.size());
+    for(uint32_t i = 0; i < _samplers.size(); ++i)
+        sampler_index.Insert(_samplers[i]._id, i);
+
     // Channels
     for(pugi::xml_node node1 = animNode.child("channel"); node1; node1 = node1.next_sibling("channel"))
     {
@@ -106,7 +247,7 @@ void DaeAnimation::Parse(pugi::xml_node const & animNode, unsigned int & maxFram
         size_t      pos = s.find("/");
         if(pos != std::string::npos && pos != s.length() - 1)
         {
-            channel._node_id   = s.substr(0, pos);
+            channel._node_id   = atoms.Intern(s.substr(0, pos));
             channel._trans_sid = s.substr(pos + 1, s.length() - pos);
             if(channel._trans_sid.find(".X") != std::string::npos)
             {
@@ -155,21 +296,12 @@ void DaeAnimation::Parse(pugi::xml_node const & animNode, unsigned int & maxFram
         }
 
         // Find source
-        s = node1.attribute("source").value();
-        RemoveGate(s);
-        if(!s.empty())
-        {
-            for(auto & smp : _samplers)
-            {
-                if(smp._id == s)
-                {
-                    channel._source = &smp;
-                    break;
-                }
-            }
-        }
+        DaeAtom          smp_id = atoms.InternRef(node1.attribute("source").value());
+        uint32_t const * ind    = smp_id != no_atom ? sampler_index.Find(smp_id) : nullptr;
+        if(ind != nullptr)
+            channel._source = &_samplers[*ind];
 
-        if(channel._node_id.empty() || channel._trans_sid.empty() || channel._source == nullptr)
+        if(channel._node_id == no_atom || channel._trans_sid.empty() || channel._source == nullptr)
         {
             std::cerr << "Warning: Missing channel attributes or sampler not found" << std::endl;
             _channels.pop_back();
@@ -180,36 +312,52 @@ void DaeAnimation::Parse(pugi::xml_node const & animNode, unsigned int & maxFram
     for(pugi::xml_node node1 = animNode.child("animation"); node1; node1 = node1.next_sibling("animation"))
     {
         _children.emplace_back();
-        _children.back().Parse(node1, maxFrameCount, maxAnimTime);
+        _children.back().Parse(node1, atoms, maxFrameCount, minAnimTime, maxAnimTime);
     }
 }
 
 /*******************************************************************************
  * DaeLibraryAnimations
  *******************************************************************************/
-void DaeLibraryAnimations::Parse(pugi::xml_node const & rootNode)
+void DaeLibraryAnimations::IndexTargets(DaeAnimation const & anim)
+{
+    // Same order as a depth-first search: own channels, then children
+    for(auto & chn : anim._channels)
+        _target_index.Insert(chn._node_id, ChannelList()).first->push_back(&chn);
+
+    for(auto & chd : anim._children)
+        IndexTargets(chd);
+}
+
+void DaeLibraryAnimations::Parse(pugi::xml_node const & rootNode, DaeAtomTable & atoms)
 {
     _max_frame_count = 0;
+    _min_anim_time   = 0.0f;
+    _max_anim_time   = 0.0f;
 
     pugi::xml_node node1 = rootNode.child("library_animations");
     if(node1.empty())
         return;
 
+    _min_anim_time = std::numeric_limits<float>::max();
+
     for(pugi::xml_node node2 = node1.child("animation"); node2; node2 = node2.next_sibling("animation"))
     {
         _animations.emplace_back();
-        _animations.back().Parse(node2, _max_frame_count, _max_anim_time);
+        _animations.back().Parse(node2, atoms, _max_frame_count, _min_anim_time, _max_anim_time);
     }
+
+    if(_min_anim_time > _max_anim_time)
+        _min_anim_time = 0.0f;
+
+    for(auto & anm : _animations)
+        IndexTargets(anm);
 }
 
-DaeSampler * DaeLibraryAnimations::FindAnimForTarget(std::string const & nodeId, int * index) const
+DaeLibraryAnimations::ChannelList const * DaeLibraryAnimations::FindChannelsForTarget(DaeAtom nodeId) const
 {
-    for(auto & anm : _animations)
-    {
-        DaeSampler * sampler = anm.FindAnimForTarget(nodeId, index);
-        if(sampler != nullptr)
-            return sampler;
-    }
+    if(nodeId == no_atom)
+        return nullptr;
 
-    return nullptr;
+    return _target_index.Find(nodeId);
 }
@@ -5,42 +5,69 @@
 
 struct DaeSampler
 {
-    std::string _id;
-    DaeSource * _input;    // Time values
-    DaeSource * _output;   // Transformation data
+    enum class Interpolation
+    {
+        LINEAR,
+        STEP,
+        BEZIER,
+        HERMITE,
+    };
+
+    DaeAtom                    _id;
+    DaeSource *                _input;           // Time values
+    DaeSource *                _output;          // Transformation data
+    DaeSource *                _in_tangent;      // Curve control data of BEZIER and HERMITE keys (optional)
+    DaeSource *                _out_tangent;     //
+    std::vector<Interpolation> _interpolation;   // Per key, LINEAR for missing values
+
+    //! Evaluate sampler at time, _output->_paramsPerItem values are written to out
+    /*! Times outside of the key range are clamped to the first and the last key */
+    void Evaluate(float time, float * out) const;
+
+    static Interpolation GetInterpolationType(std::string const & str);
 };
 
 struct DaeChannel
 {
     DaeSampler * _source;
-    std::string  _node_id;              // Target node
+    DaeAtom      _node_id;              // Target node
     std::string  _trans_sid;            // Target transformation channel
     int          _trans_values_index;   // Index in values of node transformation (-1 for no index)
 };
 
 struct DaeAnimation
 {
-    std::string               _id;
+    DaeAtom                   _id;
     std::vector<DaeSource>    _sources;
     std::vector<DaeSampler>   _samplers;
     std::vector<DaeChannel>   _channels;
     std::vector<DaeAnimation> _children;
 
-    void         Parse(pugi::xml_node const & animNode, unsigned int & maxFrameCount, float & maxAnimTime);
-    DaeSampler * FindAnimForTarget(std::string const & nodeId, int * transValuesIndex) const;
+    void Parse(pugi::xml_node const & animNode, DaeAtomTable & atoms, unsigned int & maxFrameCount,
+               float & minAnimTime, float & maxAnimTime);
 
 protected:
-    DaeSource * FindSource(std::string const & id) const;
+    DaeAtomIndex _source_index;   // source id -> _sources position
+
+    DaeSource * FindSource(DaeAtom id) const;
 };
 
-struct DaeLibraryAnimations
+class DaeLibraryAnimations
 {
+    using ChannelList = std::vector<DaeChannel const *>;
+
+    FlatHashMap<DaeAtom, ChannelList> _target_index;   // target node id -> channels in document order
+
+    void IndexTargets(DaeAnimation const & anim);
+
+public:
     std::vector<DaeAnimation> _animations;
     unsigned int              _max_frame_count;
+    float                     _min_anim_time;
     float                     _max_anim_time;
 
-    void         Parse(pugi::xml_node const & rootNode);
-    DaeSampler * FindAnimForTarget(std::string const & nodeId, int * index) const;
+    void                Parse(pugi::xml_node const & rootNode, DaeAtomTable & atoms);
+    ChannelList const * FindChannelsForTarget(DaeAtom nodeId) const;
 };
 
 #endif   // DAELIBRARYANIMATIONS_H
@@ -1,20 +1,22 @@
 #include "DaeLibraryControllers.h"
 #include "DaeParser.h"
+#include "../TextScan.h"
 #include <cstring>
 #include <iostream>
 
 /*******************************************************************************
  * DaeSkin
  *******************************************************************************/
-void DaeSkin::Parse(pugi::xml_node const & skin)
+void DaeSkin::Parse(pugi::xml_node const & skin, DaeAtomTable & atoms)
 {
-    auto Find = [&](std::string const & str) -> DaeSource * {
-        if(str.empty())
+    // A skin has a few sources, a linear search over atoms is enough
+    auto Find = [&](DaeAtom id) -> DaeSource * {
+        if(id == no_atom)
             return nullptr;
 
         for(auto & src : _sources)
         {
-            if(src._id == str)
+            if(src._id == id)
                 return &src;
         }
 
@@ -23,11 +25,10 @@ void DaeSkin::Parse(pugi::xml_node const & skin)
 
     pugi::xml_node node1 = skin.child("skin");
 
-    _id = skin.attribute("id").value();
-    if(_id.empty())
+    _id       = atoms.Intern(skin.attribute("id").value());
+    _owner_id = atoms.InternRef(node1.attribute("source").value());
+    if(_id == no_atom)
         return;
-    _owner_id = node1.attribute("source").value();
-    RemoveGate(_owner_id);
 
     // Bind shape matrix
     pugi::xml_node node2 = node1.child("bind_shape_matrix");
@@ -38,20 +39,14 @@ void DaeSkin::Parse(pugi::xml_node const & skin)
     if(str == nullptr)
         return;
     float mat4[16] = {0};
-    for(int i = 0; i < 16; ++i)
-    {
-        char * end;
-        float  f = std::strtof(str, &end);
-        str      = end;
-        mat4[i]  = f;
-    }
+    ParseNumberList(str, str + std::strlen(str), mat4, 16);
     _bind_shape_mat = CreateDAEMatrix(mat4);
 
     // Sources
     for(node2 = node1.child("source"); node2; node2 = node2.next_sibling("source"))
     {
         DaeSource source;
-        source.Parse(node2);
+        source.Parse(node2, atoms);
         _sources.push_back(std::move(source));
     }
 
@@ -63,15 +58,11 @@ void DaeSkin::Parse(pugi::xml_node const & skin)
         {
             if(strcmp(node3.attribute("semantic").value(), "JOINT") == 0)
             {
-                std::string id = node3.attribute("source").value();
-                RemoveGate(id);
-                _joint_array = Find(id);
+                _joint_array = Find(atoms.InternRef(node3.attribute("source").value()));
             }
             else if(strcmp(node3.attribute("semantic").value(), "INV_BIND_MATRIX") == 0)
             {
-                std::string sourceId = node3.attribute("source").value();
-                RemoveGate(sourceId);
-                _bind_mat_array = Find(sourceId);
+                _bind_mat_array = Find(atoms.InternRef(node3.attribute("source").value()));
             }
         }
     }
@@ -91,9 +82,7 @@ void DaeSkin::Parse(pugi::xml_node const & skin)
         {
             jointOffset = atoi(node3.attribute("offset").value());
 
-            std::string id = node3.attribute("source").value();
-            RemoveGate(id);
-            DaeSource * vertJointArray = Find(id);
+            DaeSource * vertJointArray = Find(atoms.InternRef(node3.attribute("source").value()));
             if(jointOffset != 0 || vertJointArray->_stringArray != _joint_array->_stringArray)
             {
                 std::cout << "Warning: Vertex weight joint array doesn't match skin joint array\n";
@@ -101,10 +90,8 @@ void DaeSkin::Parse(pugi::xml_node const & skin)
         }
         else if(strcmp(node3.attribute("semantic").value(), "WEIGHT") == 0)
         {
-            weightOffset   = atoi(node3.attribute("offset").value());
-            std::string id = node3.attribute("source").value();
-            RemoveGate(id);
-            _weight_array = Find(id);
+            weightOffset  = atoi(node3.attribute("offset").value());
+            _weight_array = Find(atoms.InternRef(node3.attribute("source").value()));
         }
     }
 
@@ -112,40 +99,40 @@ void DaeSkin::Parse(pugi::xml_node const & skin)
     str   = node3.text().get();
     if(str == nullptr)
         return;
-    for(int i = 0; i < count; ++i)
-    {
-        char * end;
-        int    si = std::strtol(str, &end, 10);
-        str       = end;
 
-        WeightsVec vertWeight;
-        for(unsigned int j = 0; j < (unsigned)si; ++j)
-        {
-            vertWeight.push_back(DaeWeight());
-        }
+    // Missing counts are treated as vertices without weights
+    std::vector<uint32_t> vcount;
+    vcount.reserve(count);
+    ParseNumberList(str, str + std::strlen(str), vcount, count);
+    vcount.resize(count, 0);
 
-        _vert_weights.push_back(vertWeight);
+    size_t num_weights = 0;
+    _vert_weights.resize(count);
+    for(int i = 0; i < count; ++i)
+    {
+        _vert_weights[i].resize(vcount[i]);
+        num_weights += vcount[i];
     }
 
     node3 = node2.child("v");
     str   = node3.text().get();
-    if(str == nullptr)
+    if(str == nullptr || jointOffset >= numInputs || weightOffset >= numInputs)
         return;
-    for(int i = 0; i < count; ++i)
+
+    // Joint index -1 references the bind shape, so the values are signed
+    std::vector<int32_t> values;
+    values.reserve(num_weights * numInputs);
+    ParseNumberList(str, str + std::strlen(str), values, num_weights * numInputs);
+    values.resize(num_weights * numInputs, 0);
+
+    int32_t const * val = values.data();
+    for(auto & vertWeight : _vert_weights)
     {
-        for(auto & vrtWeight : _vert_weights[i])
+        for(auto & vrtWeight : vertWeight)
         {
-            for(unsigned int k = 0; k < numInputs; ++k)
-            {
-                char * end;
-                int    si = std::strtol(str, &end, 10);
-                str       = end;
-
-                if(k == jointOffset)
-                    vrtWeight._joint = si;
-                if(k == weightOffset)
-                    vrtWeight._weight = si;
-            }
+            vrtWeight._joint  = val[jointOffset];
+            vrtWeight._weight = val[weightOffset];
+            val += numInputs;
         }
     }
 }
@@ -153,7 +140,13 @@ void DaeSkin::Parse(pugi::xml_node const & skin)
 /*******************************************************************************
  * DaeLibraryControllers
  *******************************************************************************/
-void DaeLibraryControllers::Parse(pugi::xml_node const & root)
+DaeSkin const * DaeLibraryControllers::FindSkin(DaeAtom id) const
+{
+    uint32_t const * ind = _index.Find(id);
+    return ind != nullptr ? &_skinControllers[*ind] : nullptr;
+}
+
+void DaeLibraryControllers::Parse(pugi::xml_node const & root, DaeAtomTable & atoms)
 {
     pugi::xml_node node1 = root.child("library_controllers");
     if(node1.empty())
@@ -167,7 +160,8 @@ void DaeLibraryControllers::Parse(pugi::xml_node const & root)
         if(!node3.empty())
         {
             _skinControllers.emplace_back();
-            _skinControllers.back().Parse(node2);
+            _skinControllers.back().Parse(node2, atoms);
+            _index.Insert(_skinControllers.back()._id, static_cast<uint32_t>(_skinControllers.size() - 1));
         }
     }
 }
@@ -15,8 +15,8 @@ using WeightsVec = std::vector<DaeWeight>;
 
 struct DaeSkin
 {
-    std::string             _id;
-    std::string             _owner_id;
+    DaeAtom                 _id;
+    DaeAtom                 _owner_id;   // geometry
     glm::mat4               _bind_shape_mat;
     std::vector<DaeSource>  _sources;
     DaeSource *             _joint_array;
@@ -24,14 +24,16 @@ struct DaeSkin
     DaeSource *             _bind_mat_array;
     std::vector<WeightsVec> _vert_weights;
 
-    void Parse(pugi::xml_node const & skin);
+    void Parse(pugi::xml_node const & skin, DaeAtomTable & atoms);
 };
 
 struct DaeLibraryControllers
 {
     std::vector<DaeSkin> _skinControllers;
+    DaeAtomIndex         _index;   // controller id -> _skinControllers position
 
-    void Parse(pugi::xml_node const & root);
+    void            Parse(pugi::xml_node const & root, DaeAtomTable & atoms);
+    DaeSkin const * FindSkin(DaeAtom id) const;
 };
 
 #endif   // DAELIBRARYCONTROLLERS_H
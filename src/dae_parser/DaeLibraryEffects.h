@@ -8,9 +8,9 @@
 
 struct DaeEffect
 {
-    std::string id;
+    DaeAtom     id;
     std::string name;
-    std::string diffuseMapId;
+    DaeAtom     diffuseMapId;
     std::string diffuseColor;
     std::string specularColor;
     float       shininess;
@@ -18,18 +18,20 @@ struct DaeEffect
 
     DaeEffect()
     {
-        diffuseMap = nullptr;
-        shininess  = 0.5f;
+        id           = no_atom;
+        diffuseMapId = no_atom;
+        diffuseMap   = nullptr;
+        shininess    = 0.5f;
     }
 
-    bool Parse(pugi::xml_node const & effectNode)
+    bool Parse(pugi::xml_node const & effectNode, DaeAtomTable & atoms)
     {
-        id = effectNode.attribute("id").value();
-        if(id == "")
+        id = atoms.Intern(effectNode.attribute("id").value());
+        if(id == no_atom)
             return false;
         name = effectNode.attribute("name").value();
         if(name.empty())
-            name = id;
+            name = effectNode.attribute("id").value();
 
         pugi::xml_node node1 = effectNode.child("profile_COMMON");
         if(node1.empty())
@@ -89,7 +91,7 @@ struct DaeEffect
         // and use the texture image directly instead of sampler2D
         if(node1.child("newparam").empty())
         {
-            diffuseMapId = samplerId;
+            diffuseMapId = atoms.Intern(samplerId);
             return true;
         }
 
@@ -132,7 +134,7 @@ struct DaeEffect
                         return true;
 
                     if(node4.text().get() != nullptr)
-                        diffuseMapId = node4.text().get();
+                        diffuseMapId = atoms.Intern(node4.text().get());
                 }
 
                 break;
@@ -146,22 +148,19 @@ struct DaeEffect
 struct DaeLibraryEffects
 {
     std::vector<DaeEffect> effects;
+    DaeAtomIndex           index;   // effect id -> effects position
 
-    DaeEffect * FindEffect(std::string const & id)
+    DaeEffect * FindEffect(DaeAtom id)
     {
-        if(id == "")
+        if(id == no_atom)
             return nullptr;
 
-        for(unsigned int i = 0; i < effects.size(); ++i)
-        {
-            if(effects[i].id == id)
-                return &effects[i];
-        }
+        uint32_t const * ind = index.Find(id);
 
-        return nullptr;
+        return ind != nullptr ? &effects[*ind] : nullptr;
     }
 
-    void Parse(pugi::xml_node const & rootNode)
+    void Parse(pugi::xml_node const & rootNode, DaeAtomTable & atoms)
     {
         pugi::xml_node node1 = rootNode.child("library_effects");
         if(node1.empty())
@@ -170,8 +169,10 @@ struct DaeLibraryEffects
         for(pugi::xml_node node2 = node1.child("effect"); node2; node2 = node2.next_sibling("effect"))
         {
             effects.emplace_back();
-            if(!effects.back().Parse(node2))
+            if(!effects.back().Parse(node2, atoms))
                 effects.pop_back();
+            else
+                index.Insert(effects.back().id, static_cast<uint32_t>(effects.size() - 1));
         }
     }
 };
@@ -1,21 +1,19 @@
 #include "DaeLibraryGeometries.h"
 #include "DaeParser.h"
+#include "../TextScan.h"
+#include "../ThreadPool.h"
 #include <cassert>
 #include <cstring>
 #include <sstream>
 #include <stdexcept>
 
-DaeMeshNode const * DaeLibraryGeometries::Find(std::string const & id) const
+DaeMeshNode const * DaeLibraryGeometries::Find(DaeAtom id) const
 {
-    auto it = find_if(_lib.begin(), _lib.end(), [&](DaeMeshNode const & dg) { return dg._id == id; });
-
-    if(it != _lib.end())
-        return &(*it);
-    else
-        return nullptr;
+    uint32_t const * ind = _index.Find(id);
+    return ind != nullptr ? &_lib[*ind] : nullptr;
 }
 
-void DaeLibraryGeometries::Parse(pugi::xml_node const & geo)
+void DaeLibraryGeometries::Parse(pugi::xml_node const & geo, DaeAtomTable & atoms)
 {
     pugi::xml_node libgeo = geo.child("library_geometries");
     if(libgeo.empty())
@@ -27,15 +25,23 @@ void DaeLibraryGeometries::Parse(pugi::xml_node const & geo)
         throw std::runtime_error(ss.str());
     }
 
+    std::vector<pugi::xml_node> geom_nodes;
     for(pugi::xml_node geom = libgeo.child("geometry"); geom; geom = geom.next_sibling("geometry"))
-    {
-        _lib.emplace_back();
-        _lib.back().Parse(geom);
-        _lib.back().CheckInputConsistency();
-    }
+        geom_nodes.push_back(geom);
+
+    _lib.resize(geom_nodes.size());
+    ThreadPool::Instance().ParallelFor(static_cast<uint32_t>(geom_nodes.size()), [&](uint32_t i) {
+        _lib[i].Parse(geom_nodes[i], atoms);
+        _lib[i].CheckInputConsistency();
+    });
+
+    // The first geometry with an id wins, like in a linear search
+    _index.Reserve(_lib.size());
+    for(uint32_t i = 0; i < _lib.size(); ++i)
+        _index.Insert(_lib[i]._id, i);
 }
 
-void DaeMeshNode::Parse(pugi::xml_node const & geo)
+void DaeMeshNode::Parse(pugi::xml_node const & geo, DaeAtomTable & atoms)
 {
     pugi::xml_node node1 = geo.child("mesh");
     if(node1.empty())
@@ -46,8 +52,8 @@ void DaeMeshNode::Parse(pugi::xml_node const & geo)
         throw std::runtime_error(ss.str());
     }
 
-    _id = geo.attribute("id").value();
-    if(_id.empty())
+    _id = atoms.Intern(geo.attribute("id").value());
+    if(_id == no_atom)
     {
         std::stringstream ss;
         ss << "geometry node doesnt have id '" << std::string(geo.name()) << "'\n";
@@ -58,22 +64,35 @@ void DaeMeshNode::Parse(pugi::xml_node const & geo)
     _name = geo.attribute("name").value();
     pugi::xml_node node2;
 
-    // Parse sources
+    // Parse sources, big meshes have several large arrays
+    std::vector<pugi::xml_node> source_nodes;
     for(node2 = node1.child("source"); node2; node2 = node2.next_sibling("source"))
-    {
-        _sources.emplace_back();
-        _sources.back().Parse(node2);
-    }
+        source_nodes.push_back(node2);
+
+    _sources.resize(source_nodes.size());
+    ThreadPool::Instance().ParallelFor(static_cast<uint32_t>(source_nodes.size()),
+                                       [&](uint32_t i) { _sources[i].Parse(source_nodes[i], atoms); });
+
+    DaeAtomIndex source_index;
+    source_index.Reserve(_sources.size());
+    for(uint32_t i = 0; i < _sources.size(); ++i)
+        source_index.Insert(_sources[i]._id, i);
+
+    auto find_source = [&](DaeAtom id) {
+        uint32_t const * ind = source_index.Find(id);
+        return ind != nullptr ? _sources.begin() + *ind : _sources.end();
+    };
+
+    DaeAtomIndex pos_source_index;
 
     // Parse vertex data
     for(node2 = node1.child("vertices"); node2; node2 = node2.next_sibling("vertices"))
     {
         _pos_sources.emplace_back();
-        _pos_sources.back().Parse(node2);
-        std::string posSourceId = _pos_sources.back()._pos_source_id;
-        _pos_sources.back()._pos_source_it =
-            std::find_if(_sources.begin(), _sources.end(),
-                         [&posSourceId](DaeSource const & src) -> bool { return posSourceId == src._id; });
+        _pos_sources.back().Parse(node2, atoms);
+        pos_source_index.Insert(_pos_sources.back()._id, static_cast<uint32_t>(_pos_sources.size() - 1));
+
+        _pos_sources.back()._pos_source_it = find_source(_pos_sources.back()._pos_source_id);
         if(_pos_sources.back()._pos_source_it == _sources.end())
         {
             std::stringstream ss;
@@ -90,7 +109,7 @@ void DaeMeshNode::Parse(pugi::xml_node const & geo)
            || strcmp(node2.name(), "polylist") == 0)
         {
             _tri_groups.emplace_back();
-            _tri_groups.back().Parse(node2);
+            _tri_groups.back().Parse(node2, atoms);
 
             for(auto & tg : _tri_groups.back()._meshes)
             {
@@ -98,17 +117,15 @@ void DaeMeshNode::Parse(pugi::xml_node const & geo)
                 {
                     if(attr.semantic == DaeGeometry::Semantic::VERTEX)
                     {
-                        attr.source_it = _sources.end();
-                        attr.pos_source_it =
-                            std::find_if(_pos_sources.begin(), _pos_sources.end(),
-                                         [sourceId = attr.source_id](DaeVerticesSource const & vs) -> bool {
-                                             return sourceId == vs._id;
-                                         });
+                        uint32_t const * ind = pos_source_index.Find(attr.source_id);
+
+                        attr.source_it     = _sources.end();
+                        attr.pos_source_it = ind != nullptr ? _pos_sources.begin() + *ind : _pos_sources.end();
 
                         if(attr.pos_source_it == _pos_sources.end())
                         {
                             std::stringstream ss;
-                            ss << "Source node for '" << attr.source_id << "' not found\n";
+                            ss << "Source node for '" << atoms.Str(attr.source_id) << "' not found\n";
 
                             throw std::runtime_error(ss.str());
                         }
@@ -116,16 +133,12 @@ void DaeMeshNode::Parse(pugi::xml_node const & geo)
                     else
                     {
                         attr.pos_source_it = _pos_sources.end();
-                        attr.source_it =
-                            std::find_if(_sources.begin(), _sources.end(),
-                                         [sourceId = attr.source_id](DaeSource const & vs) -> bool {
-                                             return sourceId == vs._id;
-                                         });
+                        attr.source_it     = find_source(attr.source_id);
 
                         if(attr.source_it == _sources.end())
                         {
                             std::stringstream ss;
-                            ss << "Source node for '" << attr.source_id << "' not found\n";
+                            ss << "Source node for '" << atoms.Str(attr.source_id) << "' not found\n";
 
                             throw std::runtime_error(ss.str());
                         }
@@ -189,7 +202,7 @@ DaeGeometry::Semantic DaeGeometry::GetSemanticType(char const * str)
     throw std::runtime_error(ss.str());
 }
 
-void DaeGeometry::Parse(pugi::xml_node const & polylist_node)
+void DaeGeometry::Parse(pugi::xml_node const & polylist_node, DaeAtomTable & atoms)
 {
     enum class PrimType
     {
@@ -249,8 +262,7 @@ void DaeGeometry::Parse(pugi::xml_node const & polylist_node)
         inp.offset = std::atoi(node1.attribute("offset").value());
         assert(inp.offset < offset + 1);
         inp.semantic  = GetSemanticType(node1.attribute("semantic").value());
-        inp.source_id = node1.attribute("source").value();
-        RemoveGate(inp.source_id);
+        inp.source_id = atoms.InternRef(node1.attribute("source").value());
 
         inp.set = 0;
         if(inp.semantic == Semantic::TEXCOORD || inp.semantic == Semantic::TEXTANGENT
@@ -265,9 +277,15 @@ void DaeGeometry::Parse(pugi::xml_node const & polylist_node)
 
     // Form index list for submesh
 
+    unsigned int num_attrib        = sub_mesh._attributes.size();
+    unsigned int inputs_per_vertex = offset + 1;
+
+    sub_mesh._triangles.SetStride(num_attrib);
+
     // Get vertex counts for polylists
-    char const * vcount_str = nullptr;
-    unsigned int num_verts  = 0;
+    std::vector<uint32_t> vcount;
+    size_t                vcount_pos = 0;
+    unsigned int          num_verts  = 0;
     if(prim_type == PrimType::Polylist)
     {
         if(polylist_node.child("vcount").empty())
@@ -277,9 +295,25 @@ void DaeGeometry::Parse(pugi::xml_node const & polylist_node)
 
             throw std::runtime_error(ss.str());
         }
-        vcount_str = polylist_node.child("vcount").text().get();
+
+        char const * str = polylist_node.child("vcount").text().get();
+        vcount.reserve(std::atoi(polylist_node.attribute("count").value()));
+        ParseNumberList(str, str + std::strlen(str), vcount);
+
+        size_t num_corners = 0;
+        for(auto vc : vcount)
+            num_corners += vc < 3 ? vc : (vc - 2) * 3;
+        sub_mesh._triangles.Reserve(num_corners);
+    }
+    else if(prim_type == PrimType::Triangles)
+    {
+        sub_mesh._triangles.Reserve(std::atoi(polylist_node.attribute("count").value()) * size_t(3));
     }
 
+    // Index values of one 'p' node and the current corner, reused
+    std::vector<uint32_t> values;
+    std::vector<uint32_t> cur_ind(num_attrib);
+
     // Parse actual primitive data
     //      The winding order of vertices produced is counter-clockwise
     //      and describes the front side of each polygon
@@ -294,23 +328,14 @@ void DaeGeometry::Parse(pugi::xml_node const & polylist_node)
             throw std::runtime_error(ss.str());
         }
 
-        char *       end        = nullptr;
         unsigned int cur_offset = 0, vert_cnt = 0;
-        int          si;
-        unsigned int num_attrib        = sub_mesh._attributes.size();
-        unsigned int inputs_per_vertex = offset + 1;
+        size_t       first_corner = 0;
 
-        TriangleGroup::VertexAttributes cur_ind;
-        TriangleGroup::VertexAttributes first_ind, last_ind;
-        cur_ind.resize(num_attrib);
+        values.clear();
+        ParseNumberList(str, str + std::strlen(str), values);
 
-        while(true)
+        for(uint32_t si : values)
         {
-            si = std::strtol(str, &end, 10);
-            if(str == end)
-                break;
-            str = end;
-
             unsigned int num_att_for_offset = 0, num_sets = 0;
             for(auto & attr : sub_mesh._attributes)
             {
@@ -327,9 +352,17 @@ void DaeGeometry::Parse(pugi::xml_node const & polylist_node)
             {
                 if(prim_type == PrimType::Polylist && vert_cnt == num_verts)
                 {
-                    vert_cnt   = 0;
-                    num_verts  = std::strtol(vcount_str, &end, 10);
-                    vcount_str = end;
+                    if(vcount_pos == vcount.size())
+                    {
+                        std::stringstream ss;
+                        ss << "Polylist node 'vcount' is shorter than 'p' '" << std::string(polylist_node.name())
+                           << "'\n";
+
+                        throw std::runtime_error(ss.str());
+                    }
+
+                    vert_cnt  = 0;
+                    num_verts = vcount[vcount_pos++];
                 }
 
                 if(prim_type == PrimType::Polygons || prim_type == PrimType::Polylist)
@@ -337,18 +370,18 @@ void DaeGeometry::Parse(pugi::xml_node const & polylist_node)
                     // Do simple triangulation (assumes convex polygons)
                     if(vert_cnt == 0)
                     {
-                        first_ind = cur_ind;
+                        first_corner = sub_mesh._triangles.Size();
                     }
                     else if(vert_cnt > 2)
                     {
                         // Create new triangle
-                        sub_mesh._triangles.push_back(first_ind);
-                        sub_mesh._triangles.push_back(last_ind);
+                        size_t last_corner = sub_mesh._triangles.Size() - 1;
+                        sub_mesh._triangles.PushCopy(first_corner);
+                        sub_mesh._triangles.PushCopy(last_corner);
                     }
                 }
 
-                sub_mesh._triangles.push_back(cur_ind);
-                last_ind   = cur_ind;
+                sub_mesh._triangles.PushCorner(cur_ind.data());
                 cur_offset = 0;
                 ++vert_cnt;
             }
@@ -358,10 +391,11 @@ void DaeGeometry::Parse(pugi::xml_node const & polylist_node)
     _meshes.push_back(std::move(sub_mesh));
 }
 
-void DaeVerticesSource::Parse(pugi::xml_node const & vertices_node)
+void DaeVerticesSource::Parse(pugi::xml_node const & vertices_node, DaeAtomTable & atoms)
 {
-    _id = vertices_node.attribute("id").value();
-    if(_id.empty())
+    _id            = atoms.Intern(vertices_node.attribute("id").value());
+    _pos_source_id = no_atom;
+    if(_id == no_atom)
     {
         std::stringstream ss;
         ss << "vertices node doesnt have id '" << std::string(vertices_node.name()) << "'\n";
@@ -373,12 +407,11 @@ void DaeVerticesSource::Parse(pugi::xml_node const & vertices_node)
     {
         if(strcmp(node1.attribute("semantic").value(), "POSITION") == 0)
         {
-            _pos_source_id = node1.attribute("source").value();
-            RemoveGate(_pos_source_id);
+            _pos_source_id = atoms.InternRef(node1.attribute("source").value());
         }
     }
 
-    if(_pos_source_id.empty())
+    if(_pos_source_id == no_atom)
     {
         std::stringstream ss;
         ss << "In vertices node doesnt found POSITION semantic '" << std::string(vertices_node.name())
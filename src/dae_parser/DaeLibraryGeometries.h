@@ -5,17 +5,18 @@
 #include <pugixml.hpp>
 #include <vector>
 
+#include "../IndexStream.h"
 #include "DaeSource.h"
 
 // vertices node
 // describes mesh-vertices in a mesh
 struct DaeVerticesSource
 {
-    std::string                      _id;
-    std::string                      _pos_source_id;
+    DaeAtom                          _id;
+    DaeAtom                          _pos_source_id;
     std::vector<DaeSource>::iterator _pos_source_it;   // position source array
 
-    void Parse(pugi::xml_node const & vertices_node);
+    void Parse(pugi::xml_node const & vertices_node, DaeAtomTable & atoms);
 };
 
 struct DaeGeometry
@@ -36,7 +37,7 @@ struct DaeGeometry
     struct Input
     {
         Semantic                                 semantic;
-        std::string                              source_id;
+        DaeAtom                                  source_id;
         std::vector<DaeSource>::iterator         source_it;
         std::vector<DaeVerticesSource>::iterator pos_source_it;   // for VERTEX semantic only
         int                                      set;   // for TEXCOORD, TEXTANGENT, TEXBINORMAL semantic
@@ -45,11 +46,9 @@ struct DaeGeometry
 
     struct TriangleGroup
     {
-        using VertexAttributes = std::vector<unsigned int>;   // size() == _attributes.size()
-
-        std::string                   _material_name;
-        std::vector<Input>            _attributes;
-        std::vector<VertexAttributes> _triangles;   // every 3 form triangle in CCW mode
+        std::string        _material_name;
+        std::vector<Input> _attributes;
+        IndexStream        _triangles;   // stride == _attributes.size(), every 3 corners form CCW triangle
 
         Input const & GetInput(Semantic sem) const
         {
@@ -65,28 +64,30 @@ struct DaeGeometry
 
     std::vector<TriangleGroup> _meshes;
 
-    void            Parse(pugi::xml_node const & polylist_node);
+    void            Parse(pugi::xml_node const & polylist_node, DaeAtomTable & atoms);
     static Semantic GetSemanticType(char const * str);
 };
 
 // mesh node abstraction
 struct DaeMeshNode
 {
-    std::string                    _id;
+    DaeAtom                        _id;
     std::string                    _name;
     std::vector<DaeSource>         _sources;
     std::vector<DaeVerticesSource> _pos_sources;
     std::vector<DaeGeometry>       _tri_groups;
 
-    void Parse(pugi::xml_node const & geo);
+    void Parse(pugi::xml_node const & geo, DaeAtomTable & atoms);
     void CheckInputConsistency() const;
 };
 
 class DaeLibraryGeometries
 {
+    DaeAtomIndex _index;   // geometry id -> _lib position
+
 public:
-    void                Parse(pugi::xml_node const & geo);
-    DaeMeshNode const * Find(std::string const & id) const;
+    void                Parse(pugi::xml_node const & geo, DaeAtomTable & atoms);
+    DaeMeshNode const * Find(DaeAtom id) const;
 
     std::vector<DaeMeshNode> _lib;
 };
@@ -1,24 +1,25 @@
 #ifndef _daeLibImages_H_
 #define _daeLibImages_H_
 
+#include "DaeAtomTable.h"
 #include <pugixml.hpp>
 #include <string>
 #include <vector>
 
 struct DaeImage
 {
-    std::string id;
+    DaeAtom     id;
     std::string name;
     std::string fileName;
 
-    bool Parse(pugi::xml_node const & imageNode)
+    bool Parse(pugi::xml_node const & imageNode, DaeAtomTable & atoms)
     {
-        id = imageNode.attribute("id").value();
-        if(id == "")
+        id = atoms.Intern(imageNode.attribute("id").value());
+        if(id == no_atom)
             return false;
         name = imageNode.attribute("name").value();
         if(name.empty())
-            name = id;
+            name = imageNode.attribute("id").value();
 
         if(!imageNode.child("init_from").empty() && imageNode.child("init_from").text().get() != 0x0)
         {
@@ -36,22 +37,19 @@ struct DaeImage
 struct DaeLibraryImages
 {
     std::vector<DaeImage> images;
+    DaeAtomIndex          index;   // image id -> images position
 
-    DaeImage * FindImage(std::string const & id)
+    DaeImage * FindImage(DaeAtom id)
     {
-        if(id == "")
+        if(id == no_atom)
             return nullptr;
 
-        for(unsigned int i = 0; i < images.size(); ++i)
-        {
-            if(images[i].id == id)
-                return &images[i];
-        }
+        uint32_t const * ind = index.Find(id);
 
-        return nullptr;
+        return ind != nullptr ? &images[*ind] : nullptr;
     }
 
-    void Parse(pugi::xml_node const & rootNode)
+    void Parse(pugi::xml_node const & rootNode, DaeAtomTable & atoms)
     {
         pugi::xml_node node1 = rootNode.child("library_images");
         if(node1.empty())
@@ -60,8 +58,10 @@ struct DaeLibraryImages
         for(pugi::xml_node node2 = node1.child("image"); node2; node2 = node2.next_sibling("image"))
         {
             images.emplace_back();
-            if(!images.back().Parse(node2))
+            if(!images.back().Parse(node2, atoms))
                 images.pop_back();
+            else
+                index.Insert(images.back().id, static_cast<uint32_t>(images.size() - 1));
         }
     }
 };
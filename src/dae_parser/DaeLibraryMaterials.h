@@ -2,37 +2,35 @@
 #define _daeLibMaterials_H_
 
 #include "DaeLibraryEffects.h"
-#include "DaeParser.h"
 #include <string>
 #include <vector>
 
 struct DaeMaterial
 {
-    std::string id;
+    DaeAtom     id;
     std::string name;
-    std::string effectId;
+    DaeAtom     effectId;
     DaeEffect * effect;
     bool        used;
 
     DaeMaterial()
     {
-        used   = false;
-        effect = nullptr;
+        id       = no_atom;
+        effectId = no_atom;
+        used     = false;
+        effect   = nullptr;
     }
 
-    bool Parse(pugi::xml_node const & matNode)
+    bool Parse(pugi::xml_node const & matNode, DaeAtomTable & atoms)
     {
-        id   = matNode.attribute("id").value();
+        id   = atoms.Intern(matNode.attribute("id").value());
         name = matNode.attribute("name").value();
         if(name.empty())
-            name = id;
+            name = matNode.attribute("id").value();
 
         pugi::xml_node node1 = matNode.child("instance_effect");
         if(!node1.empty())
-        {
-            effectId = node1.attribute("url").value();
-            RemoveGate(effectId);
-        }
+            effectId = atoms.InternRef(node1.attribute("url").value());
 
         return true;
     }
@@ -41,22 +39,19 @@ struct DaeMaterial
 struct DaeLibraryMaterials
 {
     std::vector<DaeMaterial> materials;
+    DaeAtomIndex             index;   // material id -> materials position
 
-    DaeMaterial * FindMaterial(std::string const & id)
+    DaeMaterial * FindMaterial(DaeAtom id)
     {
-        if(id == "")
+        if(id == no_atom)
             return nullptr;
 
-        for(unsigned int i = 0; i < materials.size(); ++i)
-        {
-            if(materials[i].id == id)
-                return &materials[i];
-        }
+        uint32_t const * ind = index.Find(id);
 
-        return nullptr;
+        return ind != nullptr ? &materials[*ind] : nullptr;
     }
 
-    void Parse(pugi::xml_node const & rootNode)
+    void Parse(pugi::xml_node const & rootNode, DaeAtomTable & atoms)
     {
         pugi::xml_node node1 = rootNode.child("library_materials");
         if(node1.empty())
@@ -65,8 +60,10 @@ struct DaeLibraryMaterials
         for(pugi::xml_node node2 = node1.child("material"); node2; node2 = node2.next_sibling("material"))
         {
             materials.emplace_back();
-            if(!materials.back().Parse(node2))
+            if(!materials.back().Parse(node2, atoms))
                 materials.pop_back();
+            else
+                index.Insert(materials.back().id, static_cast<uint32_t>(materials.size() - 1));
         }
     }
 };
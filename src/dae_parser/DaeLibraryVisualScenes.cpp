@@ -6,14 +6,14 @@
 /*******************************************************************************
  * DaeNode
  *******************************************************************************/
-void DaeNode::Parse(pugi::xml_node const & node, DaeNode * parent)
+void DaeNode::Parse(pugi::xml_node const & node, DaeAtomTable & atoms, DaeNode * parent)
 {
     _parent = parent;
 
     _reference = false;
-    _id        = node.attribute("id").value();
+    _id        = atoms.Intern(node.attribute("id").value());
     _name      = node.attribute("name").value();
-    _sid       = node.attribute("sid").value();
+    _sid       = atoms.Intern(node.attribute("sid").value());
 
     if(strcmp(node.attribute("type").value(), "JOINT") == 0)
         _joint = true;
@@ -115,6 +115,7 @@ void DaeNode::Parse(pugi::xml_node const & node, DaeNode * parent)
                 auto nd = std::make_unique<DaeNode>();
 
                 nd->_name      = url;
+                nd->_id        = atoms.Intern(url);
                 nd->_reference = true;
                 _children.push_back(std::move(nd));
             }
@@ -138,7 +139,7 @@ void DaeNode::Parse(pugi::xml_node const & node, DaeNode * parent)
                 _instances.emplace_back();
                 DaeInstance & inst = _instances.back();
 
-                inst._url = url;
+                inst._url = atoms.Intern(url);
 
                 // Find material bindings
                 pugi::xml_node node2 = node1.child("bind_material");
@@ -164,7 +165,7 @@ void DaeNode::Parse(pugi::xml_node const & node, DaeNode * parent)
     for(node1 = node.child("node"); node1; node1 = node1.next_sibling("node"))
     {
         auto nd = std::make_unique<DaeNode>();
-        nd->Parse(node1, nd.get());
+        nd->Parse(node1, atoms, nd.get());
 
         _children.push_back(std::move(nd));
     }
@@ -173,46 +174,43 @@ void DaeNode::Parse(pugi::xml_node const & node, DaeNode * parent)
 /*******************************************************************************
  * DaeVisualScene
  *******************************************************************************/
-DaeNode const * DaeVisualScene::FindNode(std::string const & id) const
+DaeNode const * DaeVisualScene::FindNode(DaeAtom id) const
 {
-    for(auto & ptr : _nodes)
-    {
-        if(ptr._id == id)
-            return &ptr;
-    }
+    uint32_t const * pos = _node_index.Find(id);
 
-    return nullptr;
+    return pos != nullptr ? &_nodes[*pos] : nullptr;
 }
 
-void DaeVisualScene::Parse(pugi::xml_node const & visScene)
+void DaeVisualScene::Parse(pugi::xml_node const & visScene, DaeAtomTable & atoms)
 {
-    _id = visScene.attribute("id").value();
-    if(_id.empty())
+    _id = atoms.Intern(visScene.attribute("id").value());
+    if(_id == no_atom)
         return;
     _name = visScene.attribute("name").value();
 
     for(pugi::xml_node node1 = visScene.child("node"); node1; node1 = node1.next_sibling("node"))
     {
         _nodes.emplace_back();
-        _nodes.back().Parse(node1);
+        _nodes.back().Parse(node1, atoms);
     }
+
+    // First node with the same id wins, like the former linear search
+    _node_index.Reserve(_nodes.size());
+    for(uint32_t i = 0; i < _nodes.size(); ++i)
+        _node_index.Insert(_nodes[i]._id, i);
 }
 
 /*******************************************************************************
  * DaeVisualScenes
  *******************************************************************************/
-DaeVisualScene const * DaeLibraryVisualScenes::Find(std::string const & id) const
+DaeVisualScene const * DaeLibraryVisualScenes::Find(DaeAtom id) const
 {
-    for(auto & ptr : _scenes)
-    {
-        if(ptr._id == id)
-            return &ptr;
-    }
+    uint32_t const * pos = _index.Find(id);
 
-    return nullptr;
+    return pos != nullptr ? &_scenes[*pos] : nullptr;
 }
 
-void DaeLibraryVisualScenes::Parse(pugi::xml_node const & root)
+void DaeLibraryVisualScenes::Parse(pugi::xml_node const & root, DaeAtomTable & atoms)
 {
     pugi::xml_node node1 = root.child("library_visual_scenes");
     if(node1.empty())
@@ -221,6 +219,10 @@ void DaeLibraryVisualScenes::Parse(pugi::xml_node const & root)
     for(pugi::xml_node node2 = node1.child("visual_scene"); node2; node2 = node2.next_sibling("visual_scene"))
     {
         _scenes.emplace_back();
-        _scenes.back().Parse(node2);
+        _scenes.back().Parse(node2, atoms);
     }
+
+    _index.Reserve(_scenes.size());
+    for(uint32_t i = 0; i < _scenes.size(); ++i)
+        _index.Insert(_scenes[i]._id, i);
 }
@@ -1,6 +1,7 @@
 #ifndef DAEVISUALSCENES_H
 #define DAEVISUALSCENES_H
 
+#include "DaeAtomTable.h"
 #include <map>
 #include <memory>
 #include <pugixml.hpp>
@@ -24,13 +25,14 @@ struct DaeTransformation
 
 struct DaeInstance
 {
-    std::string                        _url;
+    DaeAtom                            _url;
     std::map<std::string, std::string> _material_bindings;
 };
 
 struct DaeNode
 {
-    std::string _id, _sid;
+    DaeAtom     _id;   // for reference nodes - id of the referenced node
+    DaeAtom     _sid;
     std::string _name;
     std::string _root_joint_name;   // for skin instance only
     bool        _joint;
@@ -41,26 +43,29 @@ struct DaeNode
     std::vector<std::unique_ptr<DaeNode>> _children;
     std::vector<DaeInstance>              _instances;
 
-    void Parse(pugi::xml_node const & node, DaeNode * parent = nullptr);
+    void Parse(pugi::xml_node const & node, DaeAtomTable & atoms, DaeNode * parent = nullptr);
 };
 
 struct DaeVisualScene
 {
-    std::string          _id;
+    DaeAtom              _id;
     std::string          _name;
     std::vector<DaeNode> _nodes;
+    DaeAtomIndex         _node_index;   // top level node id -> _nodes position
 
-    void            Parse(pugi::xml_node const & visScene);
-    DaeNode const * FindNode(std::string const & id) const;
+    void            Parse(pugi::xml_node const & visScene, DaeAtomTable & atoms);
+    DaeNode const * FindNode(DaeAtom id) const;
 };
 
 class DaeLibraryVisualScenes
 {
+    DaeAtomIndex _index;   // scene id -> _scenes position
+
 public:
     std::vector<DaeVisualScene> _scenes;
 
-    void                   Parse(pugi::xml_node const & root);
-    DaeVisualScene const * Find(std::string const & id) const;
+    void                   Parse(pugi::xml_node const & root, DaeAtomTable & atoms);
+    DaeVisualScene const * Find(DaeAtom id) const;
 };
 
 #endif   // DAEVISUALSCENES_H
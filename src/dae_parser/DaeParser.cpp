@@ -1,7 +1,12 @@
 #include "DaeParser.h"
+#include "DaeAtomTable.h"
 #include "DaeConverter.h"
+#include "../MappedFile.h"
+#include "../ThreadPool.h"
 #include <cstring>
+#include <functional>
 #include <iostream>
+#include <iterator>
 #include <sstream>
 #include <stdexcept>
 
@@ -15,6 +20,7 @@
 
 DaeParser::DaeParser() :
     _up_axis(UpAxis::Unknown),
+    _atoms(std::make_unique<DaeAtomTable>()),
     _images(std::make_unique<DaeLibraryImages>()),
     _effects(std::make_unique<DaeLibraryEffects>()),
     _material(std::make_unique<DaeLibraryMaterials>()),
@@ -28,9 +34,14 @@ DaeParser::~DaeParser() {}
 
 void DaeParser::Parse(std::string const & fname, CmdLineOptions const & cmd)
 {
+    // The document is parsed in place: node names and texts point into the mapped pages,
+    // so the mapping has to live as long as the document. Comments, PIs, DOCTYPE, CDATA
+    // and end-of-line normalization are not needed for COLLADA data.
+    MappedFile             file(fname, MappedFile::Mode::CopyOnWrite);
     pugi::xml_document     doc;
     pugi::xml_node         root, asset;
-    pugi::xml_parse_result result = doc.load_file(fname.c_str());
+    pugi::xml_parse_result result =
+        doc.load_buffer_inplace(file.MutableData(), file.Size(), pugi::parse_minimal | pugi::parse_escapes);
 
     if(!result)
     {
@@ -81,35 +92,39 @@ void DaeParser::Parse(std::string const & fname, CmdLineOptions const & cmd)
         }
     }
 
-    // Parse libraries
-    _images->Parse(root);
-    _effects->Parse(root);
+    // Parse libraries, they are independent read-only walks over the document
+    std::function<void()> const libraries[] = {
+        [&] { _images->Parse(root, *_atoms); },
+        [&] { _effects->Parse(root, *_atoms); },
+        [&] { _material->Parse(root, *_atoms); },
+        [&] { _geom->Parse(root, *_atoms); },
+        [&] { _v_scenes->Parse(root, *_atoms); },
+        [&] { _controllers->Parse(root, *_atoms); },
+        [&] { _anim->Parse(root, *_atoms); },
+    };
+    ThreadPool::Instance().ParallelFor(static_cast<uint32_t>(std::size(libraries)),
+                                       [&libraries](uint32_t i) { libraries[i](); });
+
     // Assign images
     for(auto & effect : _effects->effects)
     {
-        if(!effect.diffuseMapId.empty())
+        if(effect.diffuseMapId != no_atom)
         {
             effect.diffuseMap = _images->FindImage(effect.diffuseMapId);
 
             if(effect.diffuseMap == nullptr)
-                std::cout << "Warning: Image '" << effect.diffuseMapId << "' not found" << std::endl;
+                std::cout << "Warning: Image '" << _atoms->Str(effect.diffuseMapId) << "' not found" << std::endl;
         }
     }
 
-    _material->Parse(root);
     // Assign effects
     for(auto & material : _material->materials)
     {
         material.effect = _effects->FindEffect(material.effectId);
 
         if(material.effect == nullptr)
-            std::cout << "Warning: Effect '" << material.effectId << "' not found" << std::endl;
+            std::cout << "Warning: Effect '" << _atoms->Str(material.effectId) << "' not found" << std::endl;
     }
-
-    _geom->Parse(root);
-    _v_scenes->Parse(root);
-    _controllers->Parse(root);
-    _anim->Parse(root);
 }
 
 std::unique_ptr<Converter> DaeParser::GetConverter() const
@@ -4,6 +4,7 @@
 #include "../Parser.h"
 #include <glm/glm.hpp>
 
+class DaeAtomTable;
 class DaeLibraryImages;
 class DaeLibraryEffects;
 class DaeLibraryMaterials;
@@ -32,6 +33,7 @@ public:
 private:
     UpAxis _up_axis;
 
+    std::unique_ptr<DaeAtomTable>           _atoms;   // ids of all libraries
     std::unique_ptr<DaeLibraryImages>       _images;
     std::unique_ptr<DaeLibraryEffects>      _effects;
     std::unique_ptr<DaeLibraryMaterials>    _material;
@@ -1,17 +1,77 @@
 #include "DaeSource.h"
+#include "../TextScan.h"
+#include "../ThreadPool.h"
 #include "../utils.h"
 #include <algorithm>
 #include <cstdlib>
+#include <cstring>
 #include <sstream>
 #include <stdexcept>
 
-void DaeSource::Parse(pugi::xml_node const & src)
+// Text of one part of a float array parsed by a thread
+constexpr size_t min_part_size = 1 << 20;
+
+// Parse up to count floats rounded to Epsilon, big arrays are split between threads at whitespace
+static size_t ParseFloatArray(char const * str, size_t count, std::vector<float> & out)
+{
+    char const * end = str + std::strlen(str);
+    size_t       len = end - str;
+
+    ThreadPool & pool      = ThreadPool::Instance();
+    size_t       num_parts = std::min<size_t>(pool.NumThreads() * 4, len / min_part_size + 1);
+
+    out.reserve(count);
+    if(num_parts == 1)
+    {
+        ParseNumberList(str, end, out, count);
+        for(auto & f : out)
+            f = RoundEps(f);
+
+        return out.size();
+    }
+
+    std::vector<char const *> bounds(num_parts + 1, end);
+    bounds[0] = str;
+    for(size_t i = 1; i < num_parts; ++i)
+    {
+        char const * p = std::max(bounds[i - 1], str + len / num_parts * i);
+        while(p < end && !IsSpace(*p))
+            ++p;
+        bounds[i] = p;
+    }
+
+    std::vector<std::vector<float>> parts(num_parts);
+    std::vector<char>               complete(num_parts);
+    pool.ParallelFor(static_cast<uint32_t>(num_parts), [&](uint32_t i) {
+        char const * p    = bounds[i];
+        auto &       part = parts[i];
+
+        part.reserve(count / num_parts + 1);
+        ParseNumberList(p, bounds[i + 1], part);
+        complete[i] = p == bounds[i + 1];
+        for(auto & f : part)
+            f = RoundEps(f);
+    });
+
+    // Like the single part parse, the data ends at the first non number
+    for(size_t i = 0; i < num_parts && out.size() < count; ++i)
+    {
+        size_t num = std::min(parts[i].size(), count - out.size());
+        out.insert(out.end(), parts[i].begin(), parts[i].begin() + num);
+        if(!complete[i])
+            break;
+    }
+
+    return out.size();
+}
+
+void DaeSource::Parse(pugi::xml_node const & src, DaeAtomTable & atoms)
 {
     bool isFloatArray = true;
     _paramsPerItem    = 1;
 
-    _id = src.attribute("id").value();
-    if(_id.empty())
+    _id = atoms.Intern(src.attribute("id").value());
+    if(_id == no_atom)
     {
         std::stringstream ss;
         ss << "source node doesnt have id '" << std::string(src.name()) << "'\n";
@@ -62,38 +122,35 @@ void DaeSource::Parse(pugi::xml_node const & src)
             throw std::runtime_error(ss.str());
         }
 
-        std::stringstream ss;
+        // Text is read straight from the document buffer
         if(isFloatArray)
-            _floatArray.reserve(count);
-        else
-        {
-            _stringArray.reserve(count);
-            std::string temp(str);
-            std::for_each(temp.begin(), temp.end(), [](std::string::value_type & c) {
-                if(c == '\t' || c == '\n' || c == '\r')
-                    c = ' ';
-            });
-            // Skip whitespace
-            while(temp[0] == ' ')
-                temp = temp.substr(1, temp.length() - 1);
-
-            ss.str(std::move(temp));
-        }
-
-        for(int i = 0; i < count; ++i)
         {
-            if(isFloatArray)
+            if(ParseFloatArray(str, count, _floatArray) != static_cast<size_t>(count))
             {
-                char * end;
-                float  f = std::strtof(str, &end);
-                _floatArray.push_back(RoundEps(f));
-                str = end;
+                std::stringstream ss;
+                ss << "source node has less data than declared '" << std::string(src.attribute("id").value())
+                   << "'\n";
+
+                throw std::runtime_error(ss.str());
             }
-            else
+        }
+        else
+        {
+            // Names are separated by any whitespace, line ends are not normalized by the parser
+            char const * end = str + std::strlen(str);
+
+            _stringArray.reserve(count);
+            for(int i = 0; i < count; ++i)
             {
-                std::string name;
-                std::getline(ss, name, ' ');
-                _stringArray.push_back(std::move(name));
+                str = SkipSpaces(str, end);
+                if(str == end)
+                    break;
+
+                char const * name = str;
+                while(str < end && !IsSpace(*str))
+                    ++str;
+
+                _stringArray.emplace_back(name, str);
             }
         }
     }
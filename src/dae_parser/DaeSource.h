@@ -1,18 +1,19 @@
 #ifndef DAESOURCE_H
 #define DAESOURCE_H
 
+#include "DaeAtomTable.h"
 #include <pugixml.hpp>
 #include <string>
 #include <vector>
 
 struct DaeSource
 {
-    std::string              _id;
+    DaeAtom                  _id;
     std::vector<float>       _floatArray;
     std::vector<std::string> _stringArray;
     unsigned int             _paramsPerItem;
 
-    void Parse(pugi::xml_node const & src);
+    void Parse(pugi::xml_node const & src, DaeAtomTable & atoms);
 };
 
 #endif   // DAESOURCE_H
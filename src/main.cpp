@@ -1,5 +1,6 @@
 #include "Exporter.h"
 #include "Parser.h"
+#include "ThreadPool.h"
 #include <iostream>
 
 int main(int argc, char ** argv)
@@ -19,6 +20,8 @@ int main(int argc, char ** argv)
         return 1;
     }
 
+    ThreadPool::SetNumThreads(cmd.threads);
+
     // Parse files
     for(auto & str : cmd.file_list)
     {
@@ -37,10 +40,28 @@ int main(int argc, char ** argv)
             converter->ExportToInternal(rep, cmd);
 
             // Optimize & additional calculation
-            rep.RemoveDegeneratedTriangles();
+            auto cleanup = rep.RemoveDegeneratedTriangles();
+            if(cleanup.degenerate_tris > 0 || cleanup.duplicate_tris > 0)
+                std::cout << "Removed " << cleanup.degenerate_tris << " degenerate and " << cleanup.duplicate_tris
+                          << " duplicate triangles, " << cleanup.unused_verts << " unused vertices" << std::endl;
+
+            rep.cache_size = cmd.cache_size;
             if(cmd.geometry_optimize)
-                rep.OptimizeIndexOrder();
+            {
+                auto algo   = cmd.cache_tipsify ? InternalData::CacheAlgo::TIPSIFY : InternalData::CacheAlgo::FORSYTH;
+                auto before = rep.CalcCacheEfficiency();
+                rep.OptimizeIndexOrder(algo);
+                if(cmd.overdraw_optimize)
+                    rep.OptimizeOverdraw(cmd.overdraw_threshold);
+                rep.OptimizeVertexFetch();
+                auto after = rep.CalcCacheEfficiency();
+
+                std::cout << "Vertex cache ACMR: " << before.acmr << " -> " << after.acmr << ", ATVR: " << before.atvr
+                          << " -> " << after.atvr << std::endl;
+            }
             rep.CompleteVertexData(cmd.chan);
+            if(cmd.animation && (cmd.anim_rot_error > 0.0f || cmd.anim_trans_error > 0.0f))
+                rep.ReduceKeyframes(cmd.relative, glm::radians(cmd.anim_rot_error), cmd.anim_trans_error);
 
             // Export to designated format
             auto exporter = Exporter::GetExporter(cmd);
@@ -1,5 +1,8 @@
 #include "ObjConverter.h"
+#include "../FlatHashMap.h"
+#include "../VertexWelder.h"
 #include "../utils.h"
+#include <algorithm>
 #include <fstream>
 #include <iostream>
 #include <sstream>
@@ -77,49 +80,81 @@ void ObjConverter::ReadMaterials(std::string const & fname, InternalData & rep)
     rep.materials.push_back(std::move(mat));
 }
 
-struct CurrObjVertexData
+// OBJ vertex is identified by its v/vt/vn index triple
+struct ObjIndexKey
 {
-    glm::vec3 pos       = glm::vec3{0.0f};
-    bool      is_normal = {false};
-    glm::vec3 nor       = glm::vec3{0.0f};
-    glm::vec2 tex       = glm::vec2{0.0f};
+    uint32_t pos, tex, nrm;
+
+    bool operator==(ObjIndexKey const & rhs) const
+    {
+        return pos == rhs.pos && tex == rhs.tex && nrm == rhs.nrm;
+    }
 };
 
-void PushVertexData(InternalData::SubMesh & msh, CurrObjVertexData const & vd)
+struct ObjIndexKeyHash
 {
-    if(msh.tex_coords.empty())
-        msh.tex_coords.resize(1);
-
-    msh.pos.push_back(vd.pos);
-    if(vd.is_normal)
-        msh.normal.push_back(vd.nor);
-    msh.tex_coords[0].push_back(vd.tex);
-}
+    size_t operator()(ObjIndexKey const & key) const
+    {
+        return HashCombine(HashCombine(key.pos, key.tex), key.nrm);
+    }
+};
 
-bool FindSimilarVertex(CurrObjVertexData const & vd, InternalData::SubMesh const & msh,
-                       unsigned int * foundInd)
+// Merge vertices with different index triples but equal (within Epsilon) attributes
+uint32_t WeldVertices(InternalData::SubMesh & sm)
 {
-    for(unsigned int i = 0; i < msh.pos.size(); i++)
+    bool     is_normal = !sm.normal.empty();
+    uint32_t stride    = is_normal ? 8 : 5;
+    uint32_t num_verts = static_cast<uint32_t>(sm.pos.size());
+
+    VertexWelder           welder;
+    std::vector<uint32_t>  remap(num_verts);
+    std::vector<glm::vec3> pos, nrm;
+    std::vector<glm::vec2> tex;
+    float                  vert[8];
+
+    welder.Reset(stride, num_verts);
+    for(uint32_t i = 0; i < num_verts; ++i)
     {
-        bool isEqual = false;
-
-        isEqual = VecEqual(vd.pos, msh.pos[i]);
-        if(vd.is_normal)
-            isEqual = isEqual && VecEqual(vd.nor, msh.normal[i]);
-        isEqual = isEqual && VecEqual(vd.tex, msh.tex_coords[0][i]);
+        glm::vec3 const & p = sm.pos[i];
+        glm::vec2 const & t = sm.tex_coords[0][i];
+
+        uint32_t k = 0;
+        vert[k++]  = p.x;
+        vert[k++]  = p.y;
+        vert[k++]  = p.z;
+        if(is_normal)
+        {
+            vert[k++] = sm.normal[i].x;
+            vert[k++] = sm.normal[i].y;
+            vert[k++] = sm.normal[i].z;
+        }
+        vert[k++] = t.x;
+        vert[k++] = t.y;
 
-        if(isEqual)
+        if(!welder.FindSimilar(vert, &remap[i]))
         {
-            *foundInd = i;
-            return true;
+            remap[i] = welder.Add(vert);
+            pos.push_back(p);
+            tex.push_back(t);
+            if(is_normal)
+                nrm.push_back(sm.normal[i]);
         }
     }
 
-    return false;
+    for(auto & ind : sm.indexes)
+        ind = remap[ind];
+
+    sm.pos.swap(pos);
+    sm.normal.swap(nrm);
+    sm.tex_coords[0].swap(tex);
+
+    return num_verts - static_cast<uint32_t>(sm.pos.size());
 }
 
 void ObjConverter::ExportToInternal(InternalData & rep, CmdLineOptions const & cmd) const
 {
+    uint32_t const no_index = 0xFFFFFFFF;
+
     if(cmd.material_export && !_parser._matlib.empty())
         ReadMaterials(_parser._matlib, rep);
 
@@ -127,38 +162,43 @@ void ObjConverter::ExportToInternal(InternalData & rep, CmdLineOptions const & c
     {
         InternalData::SubMesh sm;
         sm.material = msh._mat_name;
+        sm.tex_coords.resize(1);
 
-        for(uint32_t i = 0; i < msh._index.size(); ++i)
-        {
-            CurrObjVertexData vd;
-            bool              found         = false;
-            uint32_t          founded_index = 0;
+        bool is_normal = msh._index.Stride() > 2;
 
-            vd.pos = msh._pos[msh._index[i][0]];
-            if(msh._index[0].size() > 2)
-            {
-                vd.is_normal = true;
-                vd.nor       = msh._nrm[msh._index[i][2]];
-                vd.tex       = msh._tex[msh._index[i][1]];
-            }
-            else
-                vd.tex = msh._tex[msh._index[i][1]];
+        // Usually there is about one vertex per referenced position
+        uint32_t max_verts = msh._range[0].end - msh._range[0].begin;
+        max_verts          = std::min(max_verts, static_cast<uint32_t>(msh._index.Size()));
+
+        FlatHashMap<ObjIndexKey, uint32_t, ObjIndexKeyHash> vert_map;
+        vert_map.Reserve(max_verts);
+        sm.pos.reserve(max_verts);
+        sm.tex_coords[0].reserve(max_verts);
+        if(is_normal)
+            sm.normal.reserve(max_verts);
+        sm.indexes.reserve(msh._index.Size());
 
-            found = FindSimilarVertex(vd, sm, &founded_index);
-            if(found)
+        for(auto const & corner : msh._index)
+        {
+            ObjIndexKey key{corner[0], corner[1], is_normal ? corner[2] : no_index};
+
+            auto res = vert_map.Insert(key, static_cast<uint32_t>(sm.pos.size()));
+            if(res.second)
             {
-                sm.indexes.push_back(founded_index);
+                sm.pos.push_back(_parser._pos[key.pos]);
+                sm.tex_coords[0].push_back(_parser._tex[key.tex]);
+                if(is_normal)
+                    sm.normal.push_back(_parser._nrm[key.nrm]);
             }
-            else
-            {
-                PushVertexData(sm, vd);
 
-                unsigned int new_index = sm.pos.size() - 1;
-                sm.indexes.push_back(new_index);
-            }
+            sm.indexes.push_back(*res.first);
         }
+
+        if(cmd.obj_weld)
+            WeldVertices(sm);
+
         rep.meshes.push_back(std::move(sm));
     }
 
-    rep.CalculateBBoxes();
+    rep.CalculateBBoxes(cmd.exact_bboxes);
 }
@@ -1,156 +1,319 @@
 #include "ObjParser.h"
+#include "../MappedFile.h"
+#include "../TextScan.h"
+#include "../IndexStream.h"
+#include "../ThreadPool.h"
 #include "ObjConverter.h"
-#include <fstream>
-#include <iostream>
+#include <algorithm>
 #include <iterator>
 #include <sstream>
 #include <stdexcept>
 
-std::unique_ptr<Converter> ObjParser::GetConverter() const
-{
-    return std::make_unique<ObjConverter>(*this);
-}
+// Minimal amount of data parsed by one thread
+constexpr size_t min_chunk_size = 1 << 20;
 
-void ObjParser::Parse(std::string const & fname, CmdLineOptions const & cmd)
+// Faces and vertices between two usemtl statements of one chunk
+struct ObjGroup
 {
-    std::ifstream in(fname, std::ios::in);
-    if(!in)
+    // Corner element which holds a negative (relative) reference
+    struct RelIndex
     {
+        uint32_t corner;
+        uint32_t elem;   // 0 - v, 1 - vt, 2 - vn
+    };
+
+    bool        usemtl = false;   // group is opened by usemtl
+    std::string mat_name;
+
+    std::vector<glm::vec3> pos;
+    std::vector<glm::vec3> nrm;
+    std::vector<glm::vec2> tex;
+    IndexStream            index;
+    std::vector<RelIndex>  relative;   // counted from the group start, fixed while stitching
+};
+
+// Result of parsing part of the file that starts and ends at a line boundary
+struct ObjChunk
+{
+    std::vector<ObjGroup> groups;   // groups[0] continues the mesh of the previous chunk
+    std::string           matlib;
+    uint32_t              stride = 0;   // elements per face corner, 0 - no faces
+};
+
+static void ParseObjChunk(char const * p, char const * end, ObjChunk & chunk, std::string const & fname)
+{
+    chunk.groups.emplace_back();
+    ObjGroup * grp = &chunk.groups.back();
+
+    // Masks mark relative elements of the first, the previous and the current corner of a face
+    uint32_t first_mask = 0, last_mask = 0, cur_mask = 0;
+
+    // Record relative elements of the corner which is pushed next
+    auto add_relative = [&grp](uint32_t mask) {
+        for(uint32_t elem = 0; mask != 0; ++elem, mask >>= 1)
+        {
+            if(mask & 1)
+                grp->relative.push_back({static_cast<uint32_t>(grp->index.Size()), elem});
+        }
+    };
+
+    auto throw_error = [&fname](char const * msg) {
         std::stringstream ss;
-        ss << "Error file: " << fname << " not open!" << std::endl;
+        ss << "Obj file: " << fname << " " << msg << std::endl;
 
         throw std::runtime_error(ss.str());
-    }
+    };
+
+    auto read_name = [](char const * s, char const * line_end) {
+        s = SkipBlanks(s, line_end);
+        while(line_end > s && IsBlank(line_end[-1]))
+            --line_end;
 
-    std::string line;
-    SubMesh     sm;
-    bool        first = true;
+        return std::string(s, line_end);
+    };
 
-    while(std::getline(in, line))
+    while(p < end)
     {
-        if(line.substr(0, 2) == "v ")
+        char const * line_end = FindLineEnd(p, end);
+        char const * s        = p;
+        p                     = line_end + 1;
+
+        if(IsKeyword(s, line_end, "v"))
         {
-            std::istringstream s(line.substr(2));
-            glm::vec3          v;
-            s >> v.x;
-            s >> v.y;
-            s >> v.z;
-            sm._pos.push_back(std::move(v));
+            glm::vec3 v;
+            s += 1;
+            if(!ParseFloat(s, line_end, v.x) || !ParseFloat(s, line_end, v.y) || !ParseFloat(s, line_end, v.z))
+                throw_error("has invalid vertex data!");
+
+            grp->pos.push_back(v);
         }
-        else if(line.substr(0, 2) == "vt")
+        else if(IsKeyword(s, line_end, "vt"))
         {
-            std::istringstream s(line.substr(2));
-            glm::vec2          v;
-            s >> v.x;
-            s >> v.y;
-            sm._tex.push_back(std::move(v));
+            glm::vec2 v;
+            s += 2;
+            if(!ParseFloat(s, line_end, v.x) || !ParseFloat(s, line_end, v.y))
+                throw_error("has invalid tex coord data!");
+
+            grp->tex.push_back(v);
         }
-        else if(line.substr(0, 2) == "vn")
+        else if(IsKeyword(s, line_end, "vn"))
         {
-            std::istringstream s(line.substr(2));
-            glm::vec3          v;
-            s >> v.x;
-            s >> v.y;
-            s >> v.z;
-            sm._nrm.push_back(glm::normalize(v));
+            glm::vec3 v;
+            s += 2;
+            if(!ParseFloat(s, line_end, v.x) || !ParseFloat(s, line_end, v.y) || !ParseFloat(s, line_end, v.z))
+                throw_error("has invalid normal data!");
+
+            grp->nrm.push_back(glm::normalize(v));
         }
-        else if(line.substr(0, 6) == "usemtl")
+        else if(IsKeyword(s, line_end, "usemtl"))
         {
-            std::string mat_name = line.substr(7);
-            if(first)
-            {
-                first        = false;
-                sm._mat_name = mat_name;
-            }
-            else
-            {
-                _meshes.push_back(std::move(sm));
-                sm._mat_name = mat_name;
-            }
+            chunk.groups.emplace_back();
+            grp           = &chunk.groups.back();
+            grp->usemtl   = true;
+            grp->mat_name = read_name(s + 6, line_end);
         }
-        else if(line.substr(0, 6) == "mtllib")
+        else if(IsKeyword(s, line_end, "mtllib"))
         {
-            _matlib = line.substr(7);
+            chunk.matlib = read_name(s + 6, line_end);
         }
-        else if(line.substr(0, 2) == "f ")
+        else if(IsKeyword(s, line_end, "f"))
         {
-            // split string with space delim
-            std::vector<std::string> tokens;
-            std::istringstream       iss(line.substr(2));
-            std::copy(std::istream_iterator<std::string>(iss), std::istream_iterator<std::string>(),
-                      std::back_inserter(tokens));
-
-            uint32_t              cur_offset = 0;
-            std::vector<uint32_t> first_ind, last_ind, cur_ind;
-            for(std::string & st : tokens)
+            uint32_t cur_offset   = 0;
+            size_t   first_corner = 0;
+            s += 1;
+
+            while(true)
             {
-                // split string with delim '/'
-                // http://stackoverflow.com/a/236803/863977
-                std::vector<std::string> elems;
-                std::stringstream        ss;
-                ss.str(st);
-                std::string item;
-                while(std::getline(ss, item, '/'))
-                {
-                    elems.push_back(std::move(item));
-                }
+                s = SkipBlanks(s, line_end);
+                if(s == line_end)
+                    break;
 
-                for(std::string & el : elems)
+                // v/vt/vn, negative numbers reference vertices from the end of the lists
+                size_t const attr_count[3] = {grp->pos.size(), grp->tex.size(), grp->nrm.size()};
+                uint32_t cur_ind[3];
+                uint32_t num_elem = 0;
+                cur_mask          = 0;
+                while(true)
                 {
-                    if(el.empty())
-                    {
-                        std::stringstream ss;
-                        ss << "Obj file: " << fname << " doesnt have tex coord!" << std::endl;
+                    int32_t i;
+                    if(!ParseInt(s, line_end, i))
+                        throw_error("doesnt have tex coord!");
 
-                        throw std::runtime_error(ss.str());
-                    }
+                    if(num_elem == 3)
+                        throw_error("has invalid face data!");
 
-                    int i = std::stoi(el);
                     if(i < 0)
                     {
-                        // negative reference numbers
-                        i = sm._pos.size() + 1 + i;
+                        // Offset from the group start, may be negative until the group is stitched
+                        i = static_cast<int32_t>(attr_count[num_elem]) + i;
+                        cur_mask |= 1u << num_elem;
                     }
                     else
                         i--;
 
-                    cur_ind.push_back(i);
+                    cur_ind[num_elem++] = static_cast<uint32_t>(i);
+
+                    if(s == line_end || *s != '/')
+                        break;
+                    ++s;
                 }
 
+                // All corners of the file must have the same layout
+                if(chunk.stride == 0)
+                    chunk.stride = num_elem;
+                else if(chunk.stride != num_elem)
+                    throw_error("has faces with different vertex formats!");
+
+                if(grp->index.Empty())
+                    grp->index.SetStride(num_elem);
+
                 // Do simple triangulation (assumes convex polygons)
                 if(cur_offset == 0)
                 {
-                    first_ind = cur_ind;
+                    first_corner = grp->index.Size();
+                    first_mask   = cur_mask;
                 }
                 if(++cur_offset > 3)
                 {
-                    sm._index.push_back(first_ind);
-                    sm._index.push_back(last_ind);
+                    size_t last_corner = grp->index.Size() - 1;
+
+                    add_relative(first_mask);
+                    grp->index.PushCopy(first_corner);
+                    add_relative(last_mask);
+                    grp->index.PushCopy(last_corner);
                 }
 
-                sm._index.push_back(cur_ind);
-                last_ind = cur_ind;
-                cur_ind.clear();
+                add_relative(cur_mask);
+                grp->index.PushCorner(cur_ind);
+                last_mask = cur_mask;
             }
         }
     }
-    _meshes.push_back(std::move(sm));
+}
 
-    if(_meshes[0]._tex.empty())
+std::unique_ptr<Converter> ObjParser::GetConverter() const
+{
+    return std::make_unique<ObjConverter>(*this);
+}
+
+void ObjParser::Parse(std::string const & fname, CmdLineOptions const & cmd)
+{
+    MappedFile file(fname);
+
+    char const * data = file.Data();
+    size_t       size = file.Size();
+
+    // Split file at line boundaries, several chunks per thread to balance the load
+    ThreadPool & pool       = ThreadPool::Instance();
+    size_t       num_chunks = std::min<size_t>(pool.NumThreads() * 4, size / min_chunk_size + 1);
+
+    std::vector<char const *> bounds(num_chunks + 1, data + size);
+    bounds[0] = data;
+    for(size_t i = 1; i < num_chunks; ++i)
     {
+        char const * p = std::max(bounds[i - 1], data + size / num_chunks * i);
+        bounds[i]      = p < data + size ? std::min(FindLineEnd(p, data + size) + 1, data + size) : p;
+    }
+
+    std::vector<ObjChunk> chunks(num_chunks);
+    pool.ParallelFor(static_cast<uint32_t>(num_chunks), [&](uint32_t i) {
+        ParseObjChunk(bounds[i], bounds[i + 1], chunks[i], fname);
+    });
+
+    auto throw_error = [&fname](char const * msg) {
         std::stringstream ss;
-        ss << "Obj file: " << fname << " doesnt have tex coord!" << std::endl;
+        ss << "Obj file: " << fname << " " << msg << std::endl;
 
         throw std::runtime_error(ss.str());
+    };
+
+    uint32_t stride = 0;
+    for(auto const & chunk : chunks)
+    {
+        if(stride != 0 && chunk.stride != 0 && chunk.stride != stride)
+            throw_error("has faces with different vertex formats!");
+        if(chunk.stride != 0)
+            stride = chunk.stride;
+    }
+
+    // Corners are at least v/vt
+    if(stride == 1)
+        throw_error("doesnt have tex coord!");
+
+    // Stitch chunks in file order, vertices go to the shared pools
+    SubMesh sm;
+    bool    first = true;
+
+    for(auto & chunk : chunks)
+    {
+        if(!chunk.matlib.empty())
+            _matlib = std::move(chunk.matlib);
+
+        for(auto & grp : chunk.groups)
+        {
+            if(grp.usemtl)
+            {
+                if(first)
+                {
+                    first        = false;
+                    sm._mat_name = grp.mat_name;
+                }
+                else
+                {
+                    _meshes.push_back(std::move(sm));
+                    sm           = SubMesh();
+                    sm._mat_name = grp.mat_name;
+                }
+            }
+
+            // Relative references count from the end of the pools
+            int64_t const base[3] = {static_cast<int64_t>(_pos.size()), static_cast<int64_t>(_tex.size()),
+                                     static_cast<int64_t>(_nrm.size())};
+
+            for(auto const & rel : grp.relative)
+            {
+                uint32_t & ind = grp.index.CornerData(rel.corner)[rel.elem];
+                ind            = static_cast<uint32_t>(base[rel.elem] + static_cast<int32_t>(ind));
+            }
+
+            _pos.insert(_pos.end(), grp.pos.begin(), grp.pos.end());
+            _tex.insert(_tex.end(), grp.tex.begin(), grp.tex.end());
+            _nrm.insert(_nrm.end(), grp.nrm.begin(), grp.nrm.end());
+            sm._index.Append(grp.index);
+            grp = ObjGroup();
+        }
     }
+    _meshes.push_back(std::move(sm));
+
+    if(_tex.empty())
+        throw_error("doesnt have tex coord!");
 
-    if(!_meshes.empty() && _meshes[1]._pos.empty())
+    // Find referenced ranges and check that faces don't reference missing vertices
+    size_t const pool_size[3] = {_pos.size(), _tex.size(), _nrm.size()};
+    for(auto & msh : _meshes)
     {
-        for(uint32_t i = 1; i < _meshes.size(); ++i)
+        if(msh._index.Empty())
+            continue;
+
+        for(uint32_t elem = 0; elem < 3; ++elem)
+            msh._range[elem] = IndexRange{0xFFFFFFFF, 0};
+
+        for(auto const & corner : msh._index)
+        {
+            for(uint32_t elem = 0; elem < corner.size(); ++elem)
+            {
+                if(corner[elem] >= pool_size[elem])
+                    throw_error("has face with invalid vertex index!");
+
+                msh._range[elem].begin = std::min(msh._range[elem].begin, corner[elem]);
+                msh._range[elem].end   = std::max(msh._range[elem].end, corner[elem] + 1);
+            }
+        }
+
+        for(uint32_t elem = 0; elem < 3; ++elem)
         {
-            _meshes[i]._pos = _meshes[0]._pos;
-            _meshes[i]._nrm = _meshes[0]._nrm;
-            _meshes[i]._tex = _meshes[0]._tex;
+            if(msh._range[elem].begin > msh._range[elem].end)
+                msh._range[elem] = IndexRange();
         }
     }
 }
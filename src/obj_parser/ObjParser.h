@@ -1,6 +1,7 @@
 #ifndef OBJPARSER_H
 #define OBJPARSER_H
 
+#include "../IndexStream.h"
 #include "../Parser.h"
 #include <glm/glm.hpp>
 #include <vector>
@@ -10,16 +11,25 @@ class ObjConverter;
 class ObjParser : public Parser
 {
 protected:
-    struct SubMesh
+    //! Half-open range of pool elements referenced by a sub mesh
+    struct IndexRange
     {
-        std::vector<glm::vec3> _pos;
-        std::vector<glm::vec3> _nrm;
-        std::vector<glm::vec2> _tex;
+        uint32_t begin = 0;
+        uint32_t end   = 0;
+    };
 
-        std::string                        _mat_name;
-        std::vector<std::vector<uint32_t>> _index;
+    struct SubMesh
+    {
+        std::string _mat_name;
+        IndexStream _index;      // v/vt[/vn] corners, index the shared pools
+        IndexRange  _range[3];   // referenced v, vt, vn
     };
 
+    // Attributes of the whole file are shared by all sub meshes
+    std::vector<glm::vec3> _pos;
+    std::vector<glm::vec3> _nrm;
+    std::vector<glm::vec2> _tex;
+
     std::vector<SubMesh> _meshes;
     std::string          _matlib;
 
@@ -1,7 +1,9 @@
 #include "TxtExporter.h"
+#include "../AnimQuantize.h"
 #include "../utils.h"
 #include <algorithm>
 #include <cassert>
+#include <cmath>
 #include <fstream>
 #include <iostream>
 #include <sstream>
@@ -16,6 +18,7 @@ TxtExporter::TxtExporter(CmdLineOptions const & cmd)
     animation    = cmd.animation;
     material     = cmd.material_export;
     rel_matrices = cmd.relative;
+    rot_bits     = cmd.anim_rot_bits;
 }
 
 void TxtExporter::WriteFile(std::string const & basic_fname, InternalData const & rep) const
@@ -205,13 +208,112 @@ void TxtExporter::WriteFile(std::string const & basic_fname, InternalData const
         out << std::endl;
 
         // Write animations
-        assert(rep.joints[0].a_rot.size() == rep.num_frames);
-        assert(rep.joints[0].a_trans.size() == rep.num_frames);
+        assert(rel_matrices ? !rep.joints[0].r_rot.empty() : !rep.joints[0].a_rot.empty());
 
         out << "frames " << rep.num_frames << std::endl;
         out << "framerate " << rep.frame_rate << std::endl;
         out << std::endl;
 
+        // Quantized tracks: translation decode parameters per joint, the error introduced is reported
+        std::vector<TransRange> ranges(rep.joints.size());
+        float                   max_rot_error   = 0.0f;
+        float                   max_trans_error = 0.0f;
+        if(rot_bits > 0)
+        {
+            out << "quantization " << rot_bits << std::endl;
+            for(size_t j = 0; j < rep.joints.size(); ++j)
+            {
+                ranges[j] = TransRange(rel_matrices ? rep.joints[j].r_trans.values : rep.joints[j].a_trans.values);
+                out << "qtr " << rep.joints[j].index << " " << ranges[j].min.x << " " << ranges[j].min.y << " "
+                    << ranges[j].min.z << " " << ranges[j].scale.x << " " << ranges[j].scale.y << " "
+                    << ranges[j].scale.z << std::endl;
+            }
+            out << std::endl;
+        }
+
+        auto write_rot = [&](glm::quat const & q) {
+            if(rot_bits == 0)
+            {
+                out << RoundEps(q.x) << " " << RoundEps(q.y) << " " << RoundEps(q.z) << " " << RoundEps(q.w);
+                return;
+            }
+
+            // Angle between unit quaternions is 4 * asin(|a - b| / 2), acos of the dot is imprecise near 1
+            uint64_t  code = EncodeRotation(q, rot_bits);
+            glm::quat a    = glm::normalize(q);
+            glm::quat b    = DecodeRotation(code, rot_bits);
+            if(glm::dot(a, b) < 0.0f)
+                b = -b;
+
+            glm::quat diff = a - b;
+            float     len  = std::sqrt(glm::dot(diff, diff));
+            max_rot_error  = std::max(max_rot_error, 4.0f * std::asin(std::min(len * 0.5f, 1.0f)));
+            out << code;
+        };
+        auto write_trans = [&](size_t j, glm::vec3 const & t) {
+            if(rot_bits == 0)
+            {
+                out << RoundEps(t.x) << " " << RoundEps(t.y) << " " << RoundEps(t.z);
+                return;
+            }
+
+            uint16_t code[3];
+            ranges[j].Encode(t, code);
+            max_trans_error = std::max(max_trans_error, glm::distance(t, ranges[j].Decode(code)));
+            out << code[0] << " " << code[1] << " " << code[2];
+        };
+
+        // Reduced and static tracks are written once with their key frames, frames keep only bboxes
+        bool keyed = std::any_of(rep.joints.begin(), rep.joints.end(), [this](InternalData::JointNode const & jnt) {
+            auto const & rot   = rel_matrices ? jnt.r_rot : jnt.a_rot;
+            auto const & trans = rel_matrices ? jnt.r_trans : jnt.a_trans;
+            return !jnt.rot_keys.empty() || !jnt.trans_keys.empty() || rot.type != InternalData::TrackType::ANIMATED ||
+                   trans.type != InternalData::TrackType::ANIMATED;
+        });
+        if(keyed)
+        {
+            std::vector<uint32_t> const no_keys;
+            std::vector<uint32_t> const first_key(1, 0);
+            std::vector<uint32_t>       all_frames(rep.num_frames);
+            for(uint32_t i = 0; i < rep.num_frames; i++)
+                all_frames[i] = i;
+
+            // Identity channel has no keys, constant one has a single key
+            auto channel_keys = [&](InternalData::TrackType type,
+                                    std::vector<uint32_t> const & keys) -> std::vector<uint32_t> const & {
+                if(type == InternalData::TrackType::IDENTITY)
+                    return no_keys;
+                if(type == InternalData::TrackType::CONSTANT)
+                    return first_key;
+                return keys.empty() ? all_frames : keys;
+            };
+
+            out << "keyframes" << std::endl;
+            for(size_t j = 0; j < rep.joints.size(); ++j)
+            {
+                auto const & jnt        = rep.joints[j];
+                auto const & rot        = rel_matrices ? jnt.r_rot : jnt.a_rot;
+                auto const & trans      = rel_matrices ? jnt.r_trans : jnt.a_trans;
+                auto const & rot_keys   = channel_keys(rot.type, jnt.rot_keys);
+                auto const & trans_keys = channel_keys(trans.type, jnt.trans_keys);
+
+                out << "track " << jnt.index << " " << rot_keys.size() << " " << trans_keys.size() << std::endl;
+                for(auto key : rot_keys)
+                {
+                    out << "jrk " << key << " ";
+                    write_rot(rot[key]);
+                    out << std::endl;
+                }
+                for(auto key : trans_keys)
+                {
+                    out << "jtk " << key << " ";
+                    write_trans(j, trans[key]);
+                    out << std::endl;
+                }
+            }
+            out << std::endl;
+        }
+
         for(uint32_t i = 0; i < rep.num_frames; i++)
         {
             out << "frame " << i << std::endl;
@@ -219,26 +321,21 @@ void TxtExporter::WriteFile(std::string const & basic_fname, InternalData const
                 << RoundEps(rep.bboxes[i].min().z) << " " << RoundEps(rep.bboxes[i].max().x) << " "
                 << RoundEps(rep.bboxes[i].max().y) << " " << RoundEps(rep.bboxes[i].max().z) << std::endl;
 
-            for(auto const & jnt : rep.joints)
+            for(size_t j = 0; !keyed && j < rep.joints.size(); ++j)
             {
-                if(rel_matrices)
-                {
-                    out << "jtr " << RoundEps(jnt.r_rot[i].x) << " " << RoundEps(jnt.r_rot[i].y) << " "
-                        << RoundEps(jnt.r_rot[i].z) << " " << RoundEps(jnt.r_rot[i].w) << " "
-                        << RoundEps(jnt.r_trans[i].x) << " " << RoundEps(jnt.r_trans[i].y) << " "
-                        << RoundEps(jnt.r_trans[i].z) << std::endl;
-
-                    //glm::mat4 mt = glm::mat4_cast(jnt.r_rot[i]);
-                    //mt           = glm::column(mt, 3, glm::vec4(jnt.r_trans[i], 1.0f));
-                    //out << glm::to_string(glm::transpose(mt)) << std::endl;
-                }
-                else
-                    out << "jtr " << RoundEps(jnt.a_rot[i].x) << " " << RoundEps(jnt.a_rot[i].y) << " "
-                        << RoundEps(jnt.a_rot[i].z) << " " << RoundEps(jnt.a_rot[i].w) << " "
-                        << RoundEps(jnt.a_trans[i].x) << " " << RoundEps(jnt.a_trans[i].y) << " "
-                        << RoundEps(jnt.a_trans[i].z) << std::endl;
+                auto const & jnt = rep.joints[j];
+
+                out << "jtr ";
+                write_rot(rel_matrices ? jnt.r_rot[i] : jnt.a_rot[i]);
+                out << " ";
+                write_trans(j, rel_matrices ? jnt.r_trans[i] : jnt.a_trans[i]);
+                out << std::endl;
             }
             out << std::endl;
         }
+
+        if(rot_bits > 0)
+            std::cout << "Animation quantization error: rotation " << glm::degrees(max_rot_error)
+                      << " degrees, translation " << max_trans_error << std::endl;
     }
 }
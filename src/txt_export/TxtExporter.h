@@ -10,6 +10,8 @@ class TxtExporter : public Exporter
     bool material;
     bool rel_matrices;
 
+    uint32_t rot_bits;   // quantized rotation size, 0 - animation is written in floats
+
 public:
     TxtExporter(CmdLineOptions const & cmd);
 